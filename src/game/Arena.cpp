@@ -0,0 +1,357 @@
+#include "Arena.h"
+
+#include <algorithm>
+#include <cmath>
+
+/**
+ *   @brief   Fills the grid with bricks.
+ *   @details Every cell holds a brick. Hit points fall from
+ *            max_hit_points in the top rows to 1 in the bottom rows, so
+ *            rows of the same brick can be drawn as a single run. The
+ *            same seed always places the same explosive bricks.
+ *   @param   columns_count The width of the grid in bricks.
+ *   @param   rows_count The height of the grid in bricks.
+ *   @param   width The width of a brick in game units.
+ *   @param   height The height of a brick in game units.
+ *   @param   seed Seeds the placement of explosive bricks.
+ *   @param   explosive_percent The chance of each brick being explosive.
+ *   @return  void
+ */
+void Arena::generate(int columns_count,
+                     int rows_count,
+                     float width,
+                     float height,
+                     std::uint32_t seed,
+                     int explosive_percent)
+{
+  columns = std::max(columns_count, 0);
+  rows = std::max(rows_count, 0);
+  cell_width = width;
+  cell_height = height;
+
+  const auto cells =
+    static_cast<std::size_t>(columns) * static_cast<std::size_t>(rows);
+  hit_points.resize(cells);
+  types.resize(cells);
+  remaining = cells;
+  touching.clear();
+
+  // harder bricks at the top, with explosives scattered throughout
+  std::uint32_t state = seed;
+  for (std::size_t i = 0; i < cells; i++)
+  {
+    const auto row = i / static_cast<std::size_t>(columns);
+    hit_points[i] = static_cast<std::int32_t>(
+      max_hit_points - row * max_hit_points / static_cast<std::size_t>(rows));
+
+    state = state * 1664525U + 1013904223U;
+    types[i] = static_cast<int>((state >> 8) % 100) < explosive_percent
+                 ? ArenaBrick::EXPLOSIVE
+                 : ArenaBrick::PLAIN;
+  }
+}
+
+void Arena::clear()
+{
+  generate(0, 0, 0, 0, 0, 0);
+}
+
+/**
+ *   @brief   Damages every brick under a box, such as the ball.
+ *   @details Each brick the box has just come into contact with loses
+ *            one hit point, then any explosive bricks that were
+ *            destroyed set off a cascade. A brick the box was already
+ *            touching at the last hit is not damaged again, so a ball
+ *            that overlaps a brick for several steps costs it one hit.
+ *   @param   x The left of the box in game units.
+ *   @param   y The top of the box in game units.
+ *   @param   w The width of the box.
+ *   @param   h The height of the box.
+ *   @param   pool Runs the explosion waves.
+ *   @return  What was hit and destroyed.
+ */
+Arena::Cascade Arena::hit(float x, float y, float w, float h, ThreadPool& pool)
+{
+  Cascade result;
+  if (remaining == 0 || cell_width <= 0 || cell_height <= 0)
+  {
+    return result;
+  }
+
+  const auto toCell = [](float value, float size, int count) {
+    return std::clamp(
+      static_cast<int>(std::floor(value / size)), -1, count);
+  };
+  const int left = std::max(toCell(x, cell_width, columns), 0);
+  const int right = std::min(toCell(x + w, cell_width, columns), columns - 1);
+  const int top = std::max(toCell(y, cell_height, rows), 0);
+  const int bottom = std::min(toCell(y + h, cell_height, rows), rows - 1);
+
+  if (right >= left && bottom >= top)
+  {
+    result.tested = static_cast<std::size_t>(right - left + 1) *
+                    static_cast<std::size_t>(bottom - top + 1);
+  }
+
+  // cells are visited in order, so both contact lists stay sorted
+  std::vector<std::uint32_t> frontier;
+  std::vector<std::uint32_t> touched;
+  for (int row = top; row <= bottom; row++)
+  {
+    for (int column = left; column <= right; column++)
+    {
+      const auto cell = cellIndex(column, row);
+      if (hit_points[cell] <= 0)
+      {
+        continue;
+      }
+
+      result.hit = true;
+      touched.push_back(static_cast<std::uint32_t>(cell));
+      if (!std::binary_search(touching.begin(), touching.end(), cell))
+      {
+        damage(cell, 1, frontier, result.destroyed);
+      }
+    }
+  }
+  touching = std::move(touched);
+
+  remaining -= result.destroyed;
+  cascade(frontier, pool, result);
+  return result;
+}
+
+/**
+ *   @brief   Sets off an explosion at a cell.
+ *   @details The brick there is destroyed whatever its type and the
+ *            blast cascades as if it were explosive.
+ *   @param   column The brick's column.
+ *   @param   row The brick's row.
+ *   @param   pool Runs the explosion waves.
+ *   @return  What was destroyed.
+ */
+Arena::Cascade Arena::detonate(int column, int row, ThreadPool& pool)
+{
+  Cascade result;
+  if (column < 0 || column >= columns || row < 0 || row >= rows)
+  {
+    return result;
+  }
+
+  const auto cell = cellIndex(column, row);
+  if (hit_points[cell] > 0)
+  {
+    result.hit = true;
+    result.destroyed = 1;
+    hit_points[cell] = 0;
+    remaining--;
+  }
+
+  std::vector<std::uint32_t> frontier{ static_cast<std::uint32_t>(cell) };
+  cascade(frontier, pool, result);
+  return result;
+}
+
+int Arena::getColumns() const
+{
+  return columns;
+}
+
+int Arena::getRows() const
+{
+  return rows;
+}
+
+float Arena::getCellWidth() const
+{
+  return cell_width;
+}
+
+float Arena::getCellHeight() const
+{
+  return cell_height;
+}
+
+std::size_t Arena::getRemaining() const
+{
+  return remaining;
+}
+
+/**
+ *   @brief   The hit points left on a brick.
+ *   @return  Zero once the brick has been destroyed.
+ */
+int Arena::getHitPoints(int column, int row) const
+{
+  return std::max(hit_points[cellIndex(column, row)], 0);
+}
+
+/**
+ *   @brief   The type of a brick.
+ *   @return  NONE once the brick has been destroyed.
+ */
+ArenaBrick Arena::getType(int column, int row) const
+{
+  const auto cell = cellIndex(column, row);
+  return hit_points[cell] > 0 ? types[cell] : ArenaBrick::NONE;
+}
+
+/**
+ *   @brief   Hashes the hit points of every brick.
+ *   @details Used to check that cascades match for any thread count.
+ *   @return  A 64 bit FNV-1a hash.
+ */
+std::uint64_t Arena::hash() const
+{
+  std::uint64_t value = 14695981039346656037ULL;
+  for (const auto points : hit_points)
+  {
+    value ^= static_cast<std::uint32_t>(points);
+    value *= 1099511628211ULL;
+  }
+  return value;
+}
+
+std::size_t Arena::cellIndex(int column, int row) const
+{
+  return static_cast<std::size_t>(row) * static_cast<std::size_t>(columns) +
+         static_cast<std::size_t>(column);
+}
+
+/**
+ *   @brief   Takes hit points from a brick.
+ *   @details Only the hit that takes the brick to zero counts it as
+ *            destroyed, so each brick is destroyed and explodes once.
+ *   @return  void
+ */
+void Arena::damage(std::size_t cell,
+                   std::int32_t amount,
+                   std::vector<std::uint32_t>& exploding,
+                   std::size_t& destroyed)
+{
+  const std::int32_t before = hit_points[cell];
+  hit_points[cell] = before - amount;
+  if (before > 0 && before <= amount)
+  {
+    destroyed++;
+    if (types[cell] == ArenaBrick::EXPLOSIVE)
+    {
+      exploding.push_back(static_cast<std::uint32_t>(cell));
+    }
+  }
+}
+
+/**
+ *   @brief   Damages every brick within blast_radius of a cell.
+ *   @details Bricks already destroyed are damaged too, so the final hit
+ *            points are the same whatever order the blasts ran in.
+ *   @return  void
+ */
+void Arena::explode(std::uint32_t cell,
+                    std::vector<std::uint32_t>& exploding,
+                    std::size_t& destroyed)
+{
+  const auto width = static_cast<std::uint32_t>(columns);
+  const int column = static_cast<int>(cell % width);
+  const int row = static_cast<int>(cell / width);
+  const int left = std::max(column - blast_radius, 0);
+  const int right = std::min(column + blast_radius, columns - 1);
+  const int top = std::max(row - blast_radius, 0);
+  const int bottom = std::min(row + blast_radius, rows - 1);
+
+  for (int y = top; y <= bottom; y++)
+  {
+    for (int x = left; x <= right; x++)
+    {
+      const auto other = cellIndex(x, y);
+      if (other != cell)
+      {
+        damage(other, blast_damage, exploding, destroyed);
+      }
+    }
+  }
+}
+
+/**
+ *   @brief   Explodes the frontier wave by wave until it dies out.
+ *   @details Large waves are split into bands of rows, each at least
+ *            two blast radii tall, so blasts from two bands that are
+ *            not neighbours never reach the same brick. The even bands
+ *            run in parallel, then the odd bands, with no locks or
+ *            atomics. Each band collects its part of the next wave and
+ *            the parts are joined and sorted, so the result does not
+ *            depend on the number of threads.
+ *   @param   frontier The explosive bricks destroyed so far.
+ *   @param   pool Runs the bands.
+ *   @param   result Accumulates the destroyed bricks and waves.
+ *   @return  void
+ */
+void Arena::cascade(std::vector<std::uint32_t>& frontier,
+                    ThreadPool& pool,
+                    Cascade& result)
+{
+  std::sort(frontier.begin(), frontier.end());
+  std::vector<ThreadPool::Job> jobs;
+
+  while (!frontier.empty())
+  {
+    result.waves++;
+    result.largest_wave = std::max(result.largest_wave, frontier.size());
+
+    // an arena shallower than two bands still runs as one band
+    const std::size_t bands =
+      frontier.size() < parallel_frontier || pool.size() == 1
+        ? 1
+        : std::clamp(static_cast<std::size_t>(rows / (2 * blast_radius)),
+                     std::size_t{ 1 },
+                     pool.size() * 4);
+    wave_parts.resize(std::max(wave_parts.size(), bands));
+    wave_destroyed.assign(bands, 0);
+
+    // the frontier is sorted, so each band is a contiguous range of it
+    std::vector<std::size_t> band_start(bands + 1, frontier.size());
+    for (std::size_t band = 0; band < bands; band++)
+    {
+      const auto first_row = static_cast<std::size_t>(rows) * band / bands;
+      const auto first_cell = static_cast<std::uint32_t>(
+        first_row * static_cast<std::size_t>(columns));
+      band_start[band] = static_cast<std::size_t>(
+        std::lower_bound(frontier.begin(), frontier.end(), first_cell) -
+        frontier.begin());
+    }
+
+    const auto explodeBand = [this, &frontier, &band_start](
+                               std::size_t band) {
+      auto& exploding = wave_parts[band];
+      exploding.clear();
+      for (auto i = band_start[band]; i < band_start[band + 1]; i++)
+      {
+        explode(frontier[i], exploding, wave_destroyed[band]);
+      }
+    };
+
+    if (bands == 1)
+    {
+      explodeBand(0);
+    }
+    for (std::size_t parity = 0; parity < 2 && bands > 1; parity++)
+    {
+      jobs.clear();
+      for (std::size_t band = parity; band < bands; band += 2)
+      {
+        jobs.emplace_back([&explodeBand, band] { explodeBand(band); });
+      }
+      pool.run(jobs);
+    }
+
+    frontier.clear();
+    for (std::size_t band = 0; band < bands; band++)
+    {
+      frontier.insert(
+        frontier.end(), wave_parts[band].begin(), wave_parts[band].end());
+      result.destroyed += wave_destroyed[band];
+      remaining -= wave_destroyed[band];
+    }
+    std::sort(frontier.begin(), frontier.end());
+  }
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ThreadPool.h"
+
+/** How an arena brick behaves when it is destroyed. */
+enum class ArenaBrick : std::uint8_t
+{
+  NONE,
+  PLAIN,
+  EXPLOSIVE
+};
+
+/**
+ *  A dense grid of multi-hit bricks for the large arena mode.
+ *  Bricks are stored as flat arrays rather than entities, so grids of
+ *  a million bricks stay cheap. An explosive brick damages every brick
+ *  within blast_radius when it is destroyed, and any explosive bricks
+ *  that blast destroys go off in the next wave. Large waves are split
+ *  into bands of rows run across the thread pool, arranged so that no
+ *  two threads touch the same brick at once. The result is the same for
+ *  any number of threads.
+ */
+class Arena
+{
+ public:
+  struct Cascade
+  {
+    bool hit = false;          /**< Whether any brick was touched. */
+    std::size_t tested = 0;    /**< Cells checked under the box. */
+    std::size_t destroyed = 0; /**< Including every wave. */
+    int waves = 0;
+    std::size_t largest_wave = 0; /**< Explosions in the busiest wave. */
+  };
+
+  enum
+  {
+    max_hit_points = 3,
+    blast_radius = 2,
+    blast_damage = 2,
+    parallel_frontier = 256, /**< Smaller waves run on one thread. */
+    max_side = 4096,         /**< Most columns or rows. */
+    max_cells = 4194304      /**< Most bricks, a 2048x2048 grid. */
+  };
+
+  void generate(int columns_count,
+                int rows_count,
+                float width,
+                float height,
+                std::uint32_t seed,
+                int explosive_percent);
+  void clear();
+
+  Cascade hit(float x, float y, float w, float h, ThreadPool& pool);
+  Cascade detonate(int column, int row, ThreadPool& pool);
+
+  int getColumns() const;
+  int getRows() const;
+  float getCellWidth() const;
+  float getCellHeight() const;
+  std::size_t getRemaining() const;
+  int getHitPoints(int column, int row) const;
+  ArenaBrick getType(int column, int row) const;
+  std::uint64_t hash() const;
+
+ private:
+  std::size_t cellIndex(int column, int row) const;
+  void damage(std::size_t cell,
+              std::int32_t amount,
+              std::vector<std::uint32_t>& exploding,
+              std::size_t& destroyed);
+  void explode(std::uint32_t cell,
+               std::vector<std::uint32_t>& exploding,
+               std::size_t& destroyed);
+  void cascade(std::vector<std::uint32_t>& frontier,
+               ThreadPool& pool,
+               Cascade& result);
+
+  int columns = 0;
+  int rows = 0;
+  float cell_width = 0;
+  float cell_height = 0;
+  std::size_t remaining = 0;
+  std::vector<std::int32_t> hit_points; /**< At or below zero once gone. */
+  std::vector<ArenaBrick> types;
+  std::vector<std::uint32_t> touching; /**< Live cells under the last hit. */
+
+  std::vector<std::vector<std::uint32_t>> wave_parts;
+  std::vector<std::size_t> wave_destroyed;
+};
@@ -0,0 +1,122 @@
+#include "ArenaBench.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "Arena.h"
+
+namespace
+{
+  enum
+  {
+    repeats = 3,
+    arena_seed = 2024
+  };
+
+  const double frame_budget_ms = 1000.0 / 60.0;
+
+  struct Board
+  {
+    int columns;
+    int rows;
+    const char* name;
+    int explosive_percent;
+  };
+
+  struct Run
+  {
+    double best_ms = 0;
+    Arena::Cascade cascade;
+    std::uint64_t hash = 0;
+  };
+
+  /**
+   *   @brief   Detonates the centre of a fresh board several times.
+   *   @return  The fastest cascade and the board it left behind.
+   */
+  Run detonateBoard(const Board& board, ThreadPool& pool)
+  {
+    Run run;
+    Arena arena;
+    for (int i = 0; i < repeats; i++)
+    {
+      arena.generate(
+        board.columns, board.rows, 1, 1, arena_seed, board.explosive_percent);
+
+      const auto start = std::chrono::steady_clock::now();
+      run.cascade = arena.detonate(board.columns / 2, board.rows / 2, pool);
+      const std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+      run.best_ms =
+        i == 0 ? elapsed.count() : std::min(run.best_ms, elapsed.count());
+      run.hash = arena.hash();
+    }
+    return run;
+  }
+}
+
+/**
+ *   @brief   Times full board cascades by grid size and thread count.
+ *   @details Each board is detonated from its centre. Full boards are
+ *            all explosive, so every brick goes off; mixed boards are
+ *            part explosive, so the cascade branches and stalls.
+ *   @return  The process exit code, non zero if any thread count left
+ *            a different board.
+ */
+int runArenaBenchmark()
+{
+  const Board boards[] = { { 400, 250, "full", 100 },
+                           { 400, 250, "mixed", 40 },
+                           { 1000, 500, "full", 100 },
+                           { 1000, 1000, "full", 100 },
+                           { 1000, 1000, "mixed", 40 } };
+
+  // at least 4, so the determinism check always covers parallel waves
+  const unsigned int hardware =
+    std::max(std::thread::hardware_concurrency(), 4U);
+  std::vector<unsigned int> thread_counts;
+  for (unsigned int threads = 1; threads < hardware; threads *= 2)
+  {
+    thread_counts.push_back(threads);
+  }
+  thread_counts.push_back(hardware);
+
+  bool deterministic = true;
+  for (const auto& board : boards)
+  {
+    std::uint64_t reference = 0;
+    for (const auto threads : thread_counts)
+    {
+      ThreadPool pool(threads);
+      const auto run = detonateBoard(board, pool);
+      if (threads == thread_counts.front())
+      {
+        reference = run.hash;
+      }
+      const bool matched = run.hash == reference;
+      deterministic = deterministic && matched;
+
+      std::printf("arena %4dx%-4d %-5s %2u threads %9.3f ms  waves %4d  "
+                  "destroyed %7zu  %s%s\n",
+                  board.columns,
+                  board.rows,
+                  board.name,
+                  threads,
+                  run.best_ms,
+                  run.cascade.waves,
+                  run.cascade.destroyed,
+                  run.best_ms <= frame_budget_ms ? "within frame"
+                                                 : "over frame",
+                  matched ? "" : "  BOARD DIFFERS");
+    }
+  }
+
+  std::printf("arena: cascades %s across thread counts\n",
+              deterministic ? "match" : "DIFFER");
+  return deterministic ? 0 : 1;
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+/**
+ *  Headless benchmark of the arena cascades, run from the command line.
+ *  Detonates full boards of growing size with growing thread counts,
+ *  checks every thread count leaves the same board and reports whether
+ *  each cascade fits within a frame.
+ */
+int runArenaBenchmark();
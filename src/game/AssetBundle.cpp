@@ -0,0 +1,238 @@
+#include "AssetBundle.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+
+#ifdef __linux__
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+// PhysFS is linked through ASGE, which does not ship its header
+extern "C"
+{
+  int PHYSFS_mountMemory(const void* buffer,
+                         unsigned long long length,
+                         void (*del)(void*),
+                         const char* new_dir,
+                         const char* mount_point,
+                         int append_to_path);
+  int PHYSFS_unmount(const char* old_dir);
+}
+
+namespace
+{
+  enum
+  {
+    header_size = 12,
+    entry_size = 64,
+    name_size = 56
+  };
+
+  std::uint32_t readLittleEndian(const std::uint8_t* bytes)
+  {
+    return static_cast<std::uint32_t>(bytes[0]) |
+           (static_cast<std::uint32_t>(bytes[1]) << 8) |
+           (static_cast<std::uint32_t>(bytes[2]) << 16) |
+           (static_cast<std::uint32_t>(bytes[3]) << 24);
+  }
+}
+
+AssetBundle::~AssetBundle()
+{
+  close();
+}
+
+/**
+ *   @brief   Maps a bundle into memory and reads its index.
+ *   @param   path The bundle on disk.
+ *   @return  False if the file is missing or is not a valid bundle.
+ */
+bool AssetBundle::open(const std::string& path)
+{
+  close();
+
+#ifdef __linux__
+  const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+  {
+    return false;
+  }
+
+  struct stat info
+  {
+  };
+  if (fstat(fd, &info) == 0 && info.st_size > 0)
+  {
+    size = static_cast<std::size_t>(info.st_size);
+    void* memory = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (memory != MAP_FAILED)
+    {
+      madvise(memory, size, MADV_WILLNEED);
+      data = static_cast<const std::uint8_t*>(memory);
+      mapped = true;
+    }
+  }
+  ::close(fd);
+#endif
+
+  if (!mapped)
+  {
+    std::ifstream stream(path, std::ios::binary | std::ios::ate);
+    const auto length = stream.tellg();
+    if (!stream || length < 0)
+    {
+      return false;
+    }
+    buffer.resize(static_cast<std::size_t>(length));
+    stream.seekg(0);
+    if (!stream.read(reinterpret_cast<char*>(buffer.data()),
+                     static_cast<std::streamsize>(length)))
+    {
+      return false;
+    }
+    data = buffer.data();
+    size = buffer.size();
+  }
+
+  if (!readIndex())
+  {
+    close();
+    return false;
+  }
+  return true;
+}
+
+/**
+ *   @brief   Mounts the bundle into PhysFS.
+ *   @details Files in the bundle can then be loaded through ASGE as
+ *            mount_point/name. The memory stays mapped until close().
+ *   @param   mount_point Where to mount, such as "/bundle".
+ *   @return  True if PhysFS accepted the bundle.
+ */
+bool AssetBundle::mount(const std::string& mount_point)
+{
+  if (!isOpen() || isMounted())
+  {
+    return false;
+  }
+
+  // PhysFS identifies mounts by name, so every mount needs its own
+  static std::atomic<int> generation{ 0 };
+  const auto name = "bundle" + std::to_string(++generation) + ".pak";
+  if (PHYSFS_mountMemory(
+        data, size, nullptr, name.c_str(), mount_point.c_str(), 1) == 0)
+  {
+    return false;
+  }
+
+  archive_name = name;
+  return true;
+}
+
+/**
+ *   @brief   Unmounts and unmaps the bundle.
+ *   @return  void
+ */
+void AssetBundle::close()
+{
+  if (isMounted())
+  {
+    PHYSFS_unmount(archive_name.c_str());
+    archive_name.clear();
+  }
+
+#ifdef __linux__
+  if (mapped)
+  {
+    munmap(const_cast<std::uint8_t*>(data), size);
+  }
+#endif
+
+  mapped = false;
+  data = nullptr;
+  size = 0;
+  buffer.clear();
+  entries.clear();
+}
+
+bool AssetBundle::isOpen() const
+{
+  return data != nullptr;
+}
+
+bool AssetBundle::isMounted() const
+{
+  return !archive_name.empty();
+}
+
+const std::vector<AssetBundle::Entry>& AssetBundle::getEntries() const
+{
+  return entries;
+}
+
+std::size_t AssetBundle::getSize() const
+{
+  return size;
+}
+
+/**
+ *   @brief   Drops a file from the operating system's page cache.
+ *   @details Used to measure cold loads. Needs no special permissions,
+ *            but only applies on Linux.
+ *   @return  void
+ */
+void AssetBundle::evictFromCache(const std::string& path)
+{
+#ifdef __linux__
+  const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd >= 0)
+  {
+    fdatasync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    ::close(fd);
+  }
+#else
+  static_cast<void>(path);
+#endif
+}
+
+/**
+ *   @brief   Reads and validates the index after the header.
+ *   @return  False if the header or any entry is out of bounds.
+ */
+bool AssetBundle::readIndex()
+{
+  if (size < header_size || std::memcmp(data, "PACK", 4) != 0)
+  {
+    return false;
+  }
+
+  const std::size_t index_offset = readLittleEndian(data + 4);
+  const std::size_t index_size = readLittleEndian(data + 8);
+  if (index_size % entry_size != 0 || index_offset > size ||
+      index_size > size - index_offset)
+  {
+    return false;
+  }
+
+  for (std::size_t pos = index_offset; pos < index_offset + index_size;
+       pos += entry_size)
+  {
+    const auto* name = reinterpret_cast<const char*>(data + pos);
+    Entry entry;
+    entry.name.assign(name, std::find(name, name + name_size, '\0'));
+    entry.offset = readLittleEndian(data + pos + name_size);
+    entry.size = readLittleEndian(data + pos + name_size + 4);
+    if (entry.offset > size || entry.size > size - entry.offset)
+    {
+      return false;
+    }
+    entries.push_back(std::move(entry));
+  }
+  return true;
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ *  The packed asset bundle built by AssetPacker.
+ *  The bundle is a Quake PAK archive, memory mapped on Linux and read
+ *  into memory elsewhere, then mounted into PhysFS straight from that
+ *  memory. Images in it are uncompressed TGA, so ASGE loads them
+ *  without any PNG decoding.
+ */
+class AssetBundle
+{
+ public:
+  struct Entry
+  {
+    std::string name; /**< Path within the bundle. */
+    std::size_t offset = 0;
+    std::size_t size = 0;
+  };
+
+  AssetBundle() = default;
+  ~AssetBundle();
+
+  AssetBundle(const AssetBundle&) = delete;
+  AssetBundle& operator=(const AssetBundle&) = delete;
+
+  bool open(const std::string& path);
+  bool mount(const std::string& mount_point);
+  void close();
+
+  bool isOpen() const;
+  bool isMounted() const;
+  const std::vector<Entry>& getEntries() const;
+  std::size_t getSize() const;
+
+  static void evictFromCache(const std::string& path);
+
+ private:
+  bool readIndex();
+
+  const std::uint8_t* data = nullptr;
+  std::size_t size = 0;
+  bool mapped = false;
+  std::vector<std::uint8_t> buffer; /**< Used where mmap is unavailable. */
+  std::vector<Entry> entries;
+  std::string archive_name; /**< Identifies the PhysFS mount. */
+};
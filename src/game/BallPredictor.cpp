@@ -0,0 +1,542 @@
+#include "BallPredictor.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+using std::abs;
+
+namespace
+{
+  const double never = std::numeric_limits<double>::infinity();
+
+  /**
+   *  How early, in steps, a boundary crossing is looked at. The DDA runs
+   *  on doubles, which can put a crossing a hair after the step where
+   *  the Scalar ball makes it, so every candidate is taken this early
+   *  and confirmed on the exact position.
+   */
+  const double step_slack = 0.05;
+
+  /** How far a cached path may drift from the ball, in game units. */
+  const double on_path_tolerance = 0.01;
+
+  /**
+   *   @brief   The first whole step worth resolving for a crossing.
+   *   @param   time The crossing, in steps from the start of the leg.
+   *   @return  The step, at least 1.
+   */
+  double candidateStep(double time)
+  {
+    return std::max(1.0, std::ceil(time - step_slack));
+  }
+
+  int toCell(double value, double cell)
+  {
+    return static_cast<int>(std::floor(value / cell));
+  }
+
+  /**
+   *  One axis of the ball's box moving over the grid. Times are in
+   *  steps from the start of the leg and may be fractional.
+   */
+  struct Axis
+  {
+    double pos;
+    double size;
+    double speed;
+    double cell;
+    int low = 0; /**< The cells the box overlaps. */
+    int high = 0;
+
+    void start(double time)
+    {
+      const double at = pos + time * speed;
+      low = toCell(at, cell);
+      high = static_cast<int>(std::ceil((at + size) / cell)) - 1;
+    }
+
+    /** When the leading edge crosses into the next cell. */
+    double enterTime() const
+    {
+      if (speed > 0)
+      {
+        return ((high + 1) * cell - pos - size) / speed;
+      }
+      return speed < 0 ? (low * cell - pos) / speed : never;
+    }
+
+    /** When the trailing edge leaves a cell. */
+    double leaveTime(int index) const
+    {
+      if (speed > 0)
+      {
+        return ((index + 1) * cell - pos) / speed;
+      }
+      return speed < 0 ? (index * cell - pos - size) / speed : never;
+    }
+
+    double trailingLeaveTime() const
+    {
+      return leaveTime(speed > 0 ? low : high);
+    }
+
+    int enter()
+    {
+      return speed > 0 ? ++high : --low;
+    }
+
+    void leave()
+    {
+      if (speed > 0)
+      {
+        low++;
+      }
+      else
+      {
+        high--;
+      }
+    }
+  };
+}
+
+/**
+ *   @brief   The ball's path from its current state.
+ *   @details Answered from the cache when the ball is still on the
+ *            last path traced, which is only rebuilt once the ball's
+ *            velocity changes or a brick is destroyed. Contacts the
+ *            ball has already passed are never in a valid path, as
+ *            each one changes the velocity or destroys a brick.
+ *   @param   simulation The game, which must not be stepping.
+ *   @return  The path, valid until the next call.
+ */
+const BallPrediction& BallPredictor::predict(Simulation& simulation)
+{
+  stats.queries++;
+  const auto ball = simulation.getBallState();
+  const auto version = simulation.getBrickVersion();
+  if (isCached(ball, version))
+  {
+    return prediction;
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  trace(simulation, ball, prediction);
+  const std::chrono::duration<double, std::micro> elapsed =
+    std::chrono::steady_clock::now() - start;
+
+  stats.traces++;
+  stats.average_trace_us += (elapsed.count() - stats.average_trace_us) * 0.05;
+  cached = true;
+  origin = ball;
+  origin_version = version;
+  return prediction;
+}
+
+/**
+ *   @brief   Traces a path without the cache.
+ *   @details Each leg runs to the nearest step at which the ball could
+ *            reach a wall, the paddle line or a standing brick. The
+ *            ball is moved there in Scalar, one step's movement at a
+ *            time as the movement system does, and the step is
+ *            resolved. A step that turns out to touch nothing just
+ *            starts the next leg.
+ *   @param   simulation The game, which must not be stepping.
+ *   @param   ball Where to start from.
+ *   @param   path Overwritten with the path.
+ *   @return  void
+ */
+void BallPredictor::trace(const Simulation& simulation,
+                          const BallState& ball,
+                          BallPrediction& path)
+{
+  path.contacts.clear();
+  path.lands = false;
+  destroyed.clear();
+
+  const auto grid = simulation.getBrickGrid();
+  Leg leg{ ball.pos, ball.velocity, ball.step };
+
+  for (int legs = 0; legs < max_legs && path.contacts.size() < max_contacts;
+       legs++)
+  {
+    const int steps = nextStep(simulation, grid, ball, leg);
+    if (steps == 0)
+    {
+      return;
+    }
+
+    const Scalar move_x = leg.velocity.x * ball.step_dt;
+    const Scalar move_y = leg.velocity.y * ball.step_dt;
+    for (int i = 0; i < steps; i++)
+    {
+      leg.pos.x += move_x;
+      leg.pos.y += move_y;
+    }
+    leg.step += static_cast<std::uint64_t>(steps);
+
+    if (resolveStep(simulation, grid, ball, leg, path))
+    {
+      return;
+    }
+  }
+}
+
+/**
+ *   @brief   Forgets the cached path.
+ *   @details Only needed if the simulation is swapped for another.
+ *   @return  void
+ */
+void BallPredictor::invalidate()
+{
+  cached = false;
+}
+
+BallPredictor::Stats BallPredictor::getStats() const
+{
+  return stats;
+}
+
+/**
+ *   @brief   Whether the cached path still holds for the ball.
+ *   @details A served ball must be where the path's first leg takes it
+ *            after the steps run since. An unserved ball rides on the
+ *            paddle, so it must not have moved or been stepped.
+ *   @return  True if the cached path can be returned.
+ */
+bool BallPredictor::isCached(const BallState& ball,
+                             std::uint64_t version) const
+{
+  if (!cached || version != origin_version || ball.served != origin.served ||
+      ball.velocity.x != origin.velocity.x ||
+      ball.velocity.y != origin.velocity.y || ball.step < origin.step)
+  {
+    return false;
+  }
+
+  if (!ball.served)
+  {
+    return ball.step == origin.step && ball.pos.x == origin.pos.x &&
+           ball.pos.y == origin.pos.y;
+  }
+
+  const auto steps = static_cast<double>(ball.step - origin.step);
+  const auto drift = [steps, &ball](Scalar from, Scalar to, Scalar velocity) {
+    const double moved = toFloat(velocity * ball.step_dt);
+    return std::abs(toFloat(from) + steps * moved - toFloat(to));
+  };
+  return drift(origin.pos.x, ball.pos.x, origin.velocity.x) <=
+           on_path_tolerance &&
+         drift(origin.pos.y, ball.pos.y, origin.velocity.y) <=
+           on_path_tolerance &&
+         (!prediction.lands || ball.step < prediction.landing_step);
+}
+
+/**
+ *   @brief   The next step of a leg worth resolving.
+ *   @details The nearest of the walls, the paddle line and the first
+ *            standing brick, worked out on doubles.
+ *   @return  Steps from the start of the leg, or 0 if the ball never
+ *            reaches anything.
+ */
+int BallPredictor::nextStep(const Simulation& simulation,
+                            const BrickGrid& grid,
+                            const BallState& ball,
+                            const Leg& leg) const
+{
+  const double x = toFloat(leg.pos.x);
+  const double y = toFloat(leg.pos.y);
+  const double speed_x = toFloat(leg.velocity.x * ball.step_dt);
+  const double speed_y = toFloat(leg.velocity.y * ball.step_dt);
+  const double w = toFloat(ball.size.w);
+  const double h = toFloat(ball.size.h);
+
+  double limit = never;
+  if (speed_x < 0)
+  {
+    limit = candidateStep(x / -speed_x);
+  }
+  else if (speed_x > 0)
+  {
+    limit = candidateStep((toFloat(ball.area_width) - w - x) / speed_x);
+  }
+  if (speed_y < 0)
+  {
+    limit = std::min(limit, candidateStep(y / -speed_y));
+  }
+  else if (speed_y > 0)
+  {
+    limit = std::min(
+      limit, candidateStep((toFloat(ball.paddle_y) - h - y) / speed_y));
+  }
+
+  if (limit == never)
+  {
+    return 0;
+  }
+  return firstBrickStep(simulation, grid, ball, leg, static_cast<int>(limit));
+}
+
+/**
+ *   @brief   The first step at which the leg's box may overlap a brick.
+ *   @details Walks the cells as the box's leading edges cross into
+ *            them, in the order they are crossed. A brick counts at the
+ *            first whole step after its cell is entered, as long as the
+ *            box has not already left the cell by then; a box that only
+ *            clips a corner between two steps misses, as it does in the
+ *            stepped game. The arena can only turn a rising ball, so it
+ *            is skipped for a falling one.
+ *   @param   limit The step the leg ends at regardless.
+ *   @return  The step, or limit if no brick is met before it.
+ */
+int BallPredictor::firstBrickStep(const Simulation& simulation,
+                                  const BrickGrid& grid,
+                                  const BallState& ball,
+                                  const Leg& leg,
+                                  int limit) const
+{
+  const double speed_y = toFloat(leg.velocity.y * ball.step_dt);
+  if (grid.rows <= 0 || grid.columns <= 0 || (grid.arena && speed_y > 0))
+  {
+    return limit;
+  }
+
+  // nothing can be hit until the box reaches the bottom of the grid
+  const double y = toFloat(leg.pos.y);
+  const double grid_bottom = grid.rows * grid.cell_height;
+  double start = 0;
+  if (y >= grid_bottom)
+  {
+    if (speed_y >= 0)
+    {
+      return limit;
+    }
+    start = (grid_bottom - y) / speed_y;
+  }
+  if (candidateStep(start) >= limit)
+  {
+    return limit;
+  }
+
+  Axis x_axis{ toFloat(leg.pos.x),
+               toFloat(ball.size.w),
+               toFloat(leg.velocity.x * ball.step_dt),
+               grid.cell_width };
+  Axis y_axis{ y, toFloat(ball.size.h), speed_y, grid.cell_height };
+  x_axis.start(start);
+  y_axis.start(start);
+
+  double found = limit;
+  const auto test = [&](int column, int row, double entered) {
+    if (column < 0 || row < 0 || column >= grid.columns ||
+        row >= grid.rows || !isStanding(simulation, column, row))
+    {
+      return;
+    }
+    const double step = candidateStep(entered);
+    const double left =
+      std::min(x_axis.leaveTime(column), y_axis.leaveTime(row));
+    if (step < left + step_slack)
+    {
+      found = std::min(found, step);
+    }
+  };
+
+  for (int row = y_axis.low; row <= y_axis.high; row++)
+  {
+    for (int column = x_axis.low; column <= x_axis.high; column++)
+    {
+      test(column, row, start);
+    }
+  }
+
+  for (;;)
+  {
+    const double enter_x = x_axis.enterTime();
+    const double enter_y = y_axis.enterTime();
+    const double next = std::min(enter_x, enter_y);
+    if (candidateStep(next) >= found ||
+        (speed_y > 0 && y_axis.low >= grid.rows) ||
+        (speed_y < 0 && y_axis.high < 0))
+    {
+      return static_cast<int>(found);
+    }
+
+    // a cell the box leaves as another is entered is not overlapped
+    if (x_axis.trailingLeaveTime() <= next)
+    {
+      x_axis.leave();
+    }
+    else if (y_axis.trailingLeaveTime() <= next)
+    {
+      y_axis.leave();
+    }
+    else if (enter_x <= enter_y)
+    {
+      const int column = x_axis.enter();
+      for (int row = std::max(y_axis.low, 0);
+           row <= std::min(y_axis.high, grid.rows - 1);
+           row++)
+      {
+        test(column, row, enter_x);
+      }
+    }
+    else
+    {
+      const int row = y_axis.enter();
+      for (int column = std::max(x_axis.low, 0);
+           column <= std::min(x_axis.high, grid.columns - 1);
+           column++)
+      {
+        test(column, row, enter_y);
+      }
+    }
+  }
+}
+
+/**
+ *   @brief   Applies a step's collisions to the leg's ball.
+ *   @details Follows ball_collision on the exact position: walls, then
+ *            the paddle line, then each level brick, then the arena.
+ *            The arena always sends the ball down. Its explosions are
+ *            not followed, as nothing in the arena can turn a falling
+ *            ball.
+ *   @return  True once the ball reaches the paddle line.
+ */
+bool BallPredictor::resolveStep(const Simulation& simulation,
+                                const BrickGrid& grid,
+                                const BallState& ball,
+                                Leg& leg,
+                                BallPrediction& path)
+{
+  auto& pos = leg.pos;
+  auto& vel = leg.velocity;
+  const auto addContact = [&](BallContact::Kind kind, int column, int row) {
+    BallContact contact;
+    contact.kind = kind;
+    contact.step = leg.step;
+    contact.x = toFloat(pos.x);
+    contact.y = toFloat(pos.y);
+    contact.column = column;
+    contact.row = row;
+    path.contacts.push_back(contact);
+  };
+
+  // BALL AND GAME BOUNDARY COLLISION
+  if (pos.x <= Scalar(0))
+  {
+    if (vel.x < Scalar(0))
+    {
+      addContact(BallContact::Kind::LEFT_WALL, -1, -1);
+    }
+    vel.x = abs(vel.x);
+  }
+  else if (pos.x + ball.size.w >= ball.area_width)
+  {
+    if (vel.x > Scalar(0))
+    {
+      addContact(BallContact::Kind::RIGHT_WALL, -1, -1);
+    }
+    vel.x = -abs(vel.x);
+  }
+  if (pos.y <= Scalar(0))
+  {
+    if (vel.y < Scalar(0))
+    {
+      addContact(BallContact::Kind::CEILING, -1, -1);
+    }
+    vel.y = abs(vel.y);
+  }
+
+  // THE PADDLE LINE
+  if (pos.y + ball.size.h > ball.paddle_y)
+  {
+    path.lands = true;
+    path.landing_step = leg.step;
+    path.landing_x = toFloat(pos.x + ball.size.w / Scalar(2));
+    path.landing_y = toFloat(pos.y);
+    return true;
+  }
+
+  if (grid.rows <= 0 || grid.columns <= 0)
+  {
+    return false;
+  }
+
+  const float x = toFloat(pos.x);
+  const float y = toFloat(pos.y);
+  const float w = toFloat(ball.size.w);
+  const float h = toFloat(ball.size.h);
+  if (!grid.arena)
+  {
+    // BALL AND BRICKS COLLISION, on the cells near the ball
+    const Size brick_size{ toScalar(static_cast<float>(grid.cell_width)),
+                           toScalar(static_cast<float>(grid.cell_height)) };
+    const int left = std::max(toCell(x - 1, grid.cell_width), 0);
+    const int right =
+      std::min(toCell(x + w + 1, grid.cell_width), grid.columns - 1);
+    const int top = std::max(toCell(y - 1, grid.cell_height), 0);
+    const int bottom =
+      std::min(toCell(y + h + 1, grid.cell_height), grid.rows - 1);
+    for (int row = top; row <= bottom; row++)
+    {
+      for (int column = left; column <= right; column++)
+      {
+        const Position brick{ Scalar(column) * brick_size.w,
+                              Scalar(row) * brick_size.h };
+        if (isStanding(simulation, column, row) &&
+            overlaps(pos, ball.size, brick, brick_size))
+        {
+          vel.y = -vel.y;
+          destroyed.emplace_back(column, row);
+          addContact(BallContact::Kind::BRICK, column, row);
+        }
+      }
+    }
+    return false;
+  }
+
+  // BALL AND ARENA COLLISION, with the cells as Arena::hit finds them
+  const auto cell_width = static_cast<float>(grid.cell_width);
+  const auto cell_height = static_cast<float>(grid.cell_height);
+  const auto arenaCell = [](float value, float size, int count) {
+    return std::clamp(static_cast<int>(std::floor(value / size)), -1, count);
+  };
+  const int left = std::max(arenaCell(x, cell_width, grid.columns), 0);
+  const int right =
+    std::min(arenaCell(x + w, cell_width, grid.columns), grid.columns - 1);
+  const int top = std::max(arenaCell(y, cell_height, grid.rows), 0);
+  const int bottom =
+    std::min(arenaCell(y + h, cell_height, grid.rows), grid.rows - 1);
+  for (int row = top; row <= bottom; row++)
+  {
+    for (int column = left; column <= right; column++)
+    {
+      if (isStanding(simulation, column, row))
+      {
+        if (vel.y < Scalar(0))
+        {
+          addContact(BallContact::Kind::ARENA_BRICK, column, row);
+        }
+        vel.y = abs(vel.y);
+        return false;
+      }
+    }
+  }
+  return false;
+}
+
+/**
+ *   @brief   Whether a brick stands in a cell on the traced path.
+ *   @return  False if the path has already destroyed it.
+ */
+bool BallPredictor::isStanding(const Simulation& simulation,
+                               int column,
+                               int row) const
+{
+  return simulation.hasBrick(column, row) &&
+         std::find(destroyed.begin(),
+                   destroyed.end(),
+                   std::make_pair(column, row)) == destroyed.end();
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "FrameSnapshot.h"
+#include "Simulation.h"
+
+/**
+ *  Predicts the ball's bounces and where it reaches the paddle line,
+ *  without stepping the simulation.
+ *  The path is traced a leg at a time, from one bounce to the next.
+ *  Along each leg the ball's box is walked through the brick grid with
+ *  a DDA traversal of its leading edges, so open space costs one test
+ *  per cell boundary crossed rather than a collision pass per step.
+ *  The step found is then resolved on the ball's exact Scalar position
+ *  with the simulation's own rules, in the same order, so the path is
+ *  the one the stepped game takes, down to ties on a cell boundary.
+ *  Bricks the ball destroys along the way are left out of the rest of
+ *  the path.
+ *  The last path is cached, and stays valid until the ball's velocity
+ *  changes or a brick is destroyed, so repeated queries cost a few
+ *  compares. A predictor is not thread safe; give each thread its own.
+ */
+class BallPredictor
+{
+ public:
+  struct Stats
+  {
+    std::uint64_t queries = 0;
+    std::uint64_t traces = 0; /**< Queries the cache could not answer. */
+    double average_trace_us = 0;
+  };
+
+  enum
+  {
+    max_contacts = 256, /**< A path is cut short after this many. */
+    max_legs = 1024     /**< Or after this many straight runs. */
+  };
+
+  const BallPrediction& predict(Simulation& simulation);
+  void trace(const Simulation& simulation,
+             const BallState& ball,
+             BallPrediction& path);
+  void invalidate();
+  Stats getStats() const;
+
+ private:
+  /** A straight run of the ball, from the step it starts on. */
+  struct Leg
+  {
+    Position pos;
+    Velocity velocity;
+    std::uint64_t step = 0;
+  };
+
+  bool isCached(const BallState& ball, std::uint64_t version) const;
+  int nextStep(const Simulation& simulation,
+               const BrickGrid& grid,
+               const BallState& ball,
+               const Leg& leg) const;
+  int firstBrickStep(const Simulation& simulation,
+                     const BrickGrid& grid,
+                     const BallState& ball,
+                     const Leg& leg,
+                     int limit) const;
+  bool resolveStep(const Simulation& simulation,
+                   const BrickGrid& grid,
+                   const BallState& ball,
+                   Leg& leg,
+                   BallPrediction& path);
+  bool isStanding(const Simulation& simulation,
+                  int column,
+                  int row) const;
+
+  bool cached = false;
+  BallState origin; /**< The state the cached path was traced from. */
+  std::uint64_t origin_version = 0;
+  BallPrediction prediction;
+
+  std::vector<std::pair<int, int>> destroyed; /**< On the traced path. */
+  Stats stats;
+};
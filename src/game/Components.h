@@ -0,0 +1,84 @@
+#pragma once
+#include <cstdint>
+
+#include "ECS.h"
+#include "Physics.h"
+#include "ScriptScheduler.h"
+#include "Textures.h"
+
+/** Top left corner of an entity, in game units. */
+struct Position
+{
+  Scalar x = Scalar(0);
+  Scalar y = Scalar(0);
+};
+
+/** Axis aligned extents of an entity, in game units. */
+struct Size
+{
+  Scalar w = Scalar(0);
+  Scalar h = Scalar(0);
+};
+
+/** Movement in game units per second. */
+struct Velocity
+{
+  Scalar x = Scalar(0);
+  Scalar y = Scalar(0);
+};
+
+/** Draw order, back to front. */
+enum class DrawLayer : std::uint8_t
+{
+  GEMS, /**< Behind the bricks, so a gem shows once its brick breaks. */
+  BRICKS,
+  PLAYER,
+  COUNT
+};
+
+/** Draws the entity with a shared sprite for the given texture. */
+struct Renderable
+{
+  TextureId texture = TextureId::BALL;
+  DrawLayer layer = DrawLayer::PLAYER;
+};
+
+/** Marks the player controlled paddle. */
+struct Paddle
+{
+  Scalar speed = Scalar(450);
+};
+
+/** The ball. Until it is served it rides on the paddle. */
+struct Ball
+{
+  bool served = false;
+  Scalar serve_x = Scalar(300);
+  Scalar serve_y = Scalar(-300);
+};
+
+/** A brick, destroyed by a single hit from the ball. */
+struct Brick
+{
+  int points = 1;
+  int row = 0;
+  int column = 0;
+};
+
+/** A pickup that falls once its trigger brick has been destroyed. */
+struct Gem
+{
+  Entity trigger;
+  int trigger_row = 0;
+  int trigger_column = 0;
+  int points = 10;
+  Scalar fall_speed = Scalar(200);
+  TaskId release_script = 0; /**< Waits for the trigger. */
+};
+
+/** Singleton holding the player's progress. */
+struct Session
+{
+  int lives = 3;
+  int score = 0;
+};
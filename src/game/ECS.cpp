@@ -0,0 +1,352 @@
+#include "ECS.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+  std::array<ComponentRegistry::Info, ComponentRegistry::max_components>
+    component_infos;
+  std::atomic<std::size_t> component_count{ 0 };
+  std::mutex component_mutex;
+
+  std::size_t alignUp(std::size_t value, std::size_t align)
+  {
+    return (value + align - 1) / align * align;
+  }
+}
+
+/**
+ *   @brief   Registers a new component type.
+ *   @details Called once per type by ComponentRegistry::id<T>().
+ *            Aborts past max_components, in every build.
+ *   @param   info The size and alignment of the component.
+ *   @return  The id assigned to the component type.
+ */
+std::size_t ComponentRegistry::add(Info info)
+{
+  std::lock_guard<std::mutex> lock(component_mutex);
+  const std::size_t type_id = component_count.load();
+  if (type_id >= max_components)
+  {
+    // a mask has one bit per type, so there is no way to carry on
+    std::fprintf(stderr,
+                 "ECS: more than %d component types\n",
+                 static_cast<int>(max_components));
+    std::abort();
+  }
+  component_infos[type_id] = info;
+  component_count.store(type_id + 1);
+  return type_id;
+}
+
+/**
+ *   @brief   Looks up the size and alignment of a component type.
+ *   @param   type_id The id returned by ComponentRegistry::id<T>().
+ *   @return  The component's layout information.
+ */
+const ComponentRegistry::Info& ComponentRegistry::info(std::size_t type_id)
+{
+  return component_infos[type_id];
+}
+
+/**
+ *   @brief   Constructor.
+ *   @details Lays out one dense array per component inside each chunk,
+ *            sizing the chunk so every array fits in chunk_bytes.
+ *   @param   component_mask The set of components stored.
+ */
+Archetype::Archetype(ComponentMask component_mask) : mask(component_mask)
+{
+  column_index.fill(-1);
+
+  std::size_t row_bytes = 0;
+  for (std::size_t type_id = 0; type_id < ComponentRegistry::max_components;
+       type_id++)
+  {
+    if (mask & (ComponentMask(1) << type_id))
+    {
+      const auto& info = ComponentRegistry::info(type_id);
+      column_index[type_id] = static_cast<std::int8_t>(columns.size());
+      columns.push_back(Column{ type_id, info.size, 0 });
+      row_bytes += info.size + info.align;
+    }
+  }
+
+  const std::size_t rows = chunk_bytes / std::max<std::size_t>(1, row_bytes);
+  capacity = std::max<std::size_t>(1, rows);
+
+  std::size_t offset = 0;
+  for (auto& column : columns)
+  {
+    const auto& info = ComponentRegistry::info(column.type_id);
+    offset = alignUp(offset, info.align);
+    column.offset = offset;
+    offset += column.size * capacity;
+  }
+}
+
+ComponentMask Archetype::getMask() const
+{
+  return mask;
+}
+
+std::size_t Archetype::getChunkCapacity() const
+{
+  return capacity;
+}
+
+std::size_t Archetype::size() const
+{
+  return entity_count;
+}
+
+std::vector<Chunk>& Archetype::getChunks()
+{
+  return chunks;
+}
+
+const std::vector<Chunk>& Archetype::getChunks() const
+{
+  return chunks;
+}
+
+bool Archetype::hasComponent(std::size_t type_id) const
+{
+  return column_index[type_id] >= 0;
+}
+
+/**
+ *   @brief   Address of a single component.
+ *   @param   location The chunk and row holding the entity.
+ *   @param   type_id The component type to look up.
+ *   @return  Pointer to the component's bytes.
+ */
+void* Archetype::component(const Location& location, std::size_t type_id)
+{
+  const Column& column = columns[column_index[type_id]];
+  return chunks[location.chunk].data.get() + column.offset +
+         column.size * location.row;
+}
+
+/**
+ *   @brief   Reserves a row for a new entity.
+ *   @details A new chunk is added when the last one is full.
+ *   @param   entity The entity that will occupy the row.
+ *   @return  The chunk and row assigned to the entity.
+ */
+Archetype::Location Archetype::allocate(Entity entity)
+{
+  if (chunks.empty() || chunks.back().entities.size() == capacity)
+  {
+    std::size_t bytes = 0;
+    for (const auto& column : columns)
+    {
+      bytes = std::max(bytes, column.offset + column.size * capacity);
+    }
+
+    Chunk chunk;
+    chunk.data.reset(new unsigned char[std::max<std::size_t>(1, bytes)]);
+    chunk.entities.reserve(capacity);
+    chunks.push_back(std::move(chunk));
+  }
+
+  Location location;
+  location.chunk = static_cast<std::uint32_t>(chunks.size() - 1);
+  location.row = static_cast<std::uint32_t>(chunks.back().entities.size());
+  chunks.back().entities.push_back(entity);
+  entity_count++;
+  return location;
+}
+
+/**
+ *   @brief   Frees a row, keeping the storage dense.
+ *   @details The archetype's last entity is moved into the hole.
+ *   @param   location The row to free.
+ *   @return  The entity that was moved into the row, or the removed
+ *            entity itself when no move was necessary.
+ */
+Entity Archetype::remove(const Location& location)
+{
+  Chunk& last = chunks.back();
+  const auto last_chunk = static_cast<std::uint32_t>(chunks.size() - 1);
+  const auto last_row = static_cast<std::uint32_t>(last.entities.size() - 1);
+
+  Chunk& target = chunks[location.chunk];
+  Entity moved = target.entities[location.row];
+
+  if (location.chunk != last_chunk || location.row != last_row)
+  {
+    for (const auto& column : columns)
+    {
+      std::memcpy(target.data.get() + column.offset +
+                    column.size * location.row,
+                  last.data.get() + column.offset + column.size * last_row,
+                  column.size);
+    }
+    moved = last.entities[last_row];
+    target.entities[location.row] = moved;
+  }
+
+  last.entities.pop_back();
+  if (last.entities.empty())
+  {
+    chunks.pop_back();
+  }
+  entity_count--;
+  return moved;
+}
+
+/**
+ *   @brief   Destroys an entity immediately.
+ *   @details Must not be called while a query is iterating.
+ *   @param   entity The entity to destroy. Stale handles are ignored.
+ *   @return  void
+ */
+void World::destroy(Entity entity)
+{
+  if (!isAlive(entity))
+  {
+    return;
+  }
+
+  Record& record = records[entity.index];
+  const Entity moved = record.archetype->remove(record.location);
+  if (moved != entity)
+  {
+    records[moved.index].location = record.location;
+  }
+
+  record.archetype = nullptr;
+  record.generation++;
+  free_indices.push_back(entity.index);
+  alive_count--;
+}
+
+/**
+ *   @brief   Queues an entity for destruction.
+ *   @details Safe to call from systems running in parallel. The entity
+ *            stays alive until the next call to flush().
+ *   @param   entity The entity to destroy.
+ *   @return  void
+ */
+void World::destroyDeferred(Entity entity)
+{
+  std::lock_guard<std::mutex> lock(deferred_mutex);
+  deferred.push_back(entity);
+}
+
+/**
+ *   @brief   Applies all queued destructions.
+ *   @return  void
+ */
+void World::flush()
+{
+  std::vector<Entity> pending;
+  {
+    std::lock_guard<std::mutex> lock(deferred_mutex);
+    pending.swap(deferred);
+  }
+
+  for (const auto& entity : pending)
+  {
+    destroy(entity);
+  }
+}
+
+/**
+ *   @brief   Removes every entity and archetype.
+ *   @details Handles to the removed entities become stale.
+ *   @return  void
+ */
+void World::clear()
+{
+  for (std::uint32_t i = 0; i < records.size(); i++)
+  {
+    if (records[i].archetype)
+    {
+      records[i].archetype = nullptr;
+      records[i].generation++;
+      free_indices.push_back(i);
+    }
+  }
+
+  archetypes.clear();
+  archetype_order.clear();
+  alive_count = 0;
+
+  std::lock_guard<std::mutex> lock(deferred_mutex);
+  deferred.clear();
+}
+
+bool World::isAlive(Entity entity) const
+{
+  return entity.index < records.size() &&
+         records[entity.index].archetype != nullptr &&
+         records[entity.index].generation == entity.generation;
+}
+
+std::size_t World::entityCount() const
+{
+  return alive_count;
+}
+
+std::size_t World::archetypeCount() const
+{
+  return archetype_order.size();
+}
+
+/**
+ *   @brief   Describes the current storage layout.
+ *   @return  Entity and chunk counts for every archetype.
+ */
+std::vector<World::ArchetypeStats> World::archetypeStats() const
+{
+  std::vector<ArchetypeStats> stats;
+  stats.reserve(archetype_order.size());
+  for (const Archetype* archetype : archetype_order)
+  {
+    stats.push_back(ArchetypeStats{ archetype->getMask(),
+                                    archetype->size(),
+                                    archetype->getChunks().size() });
+  }
+  return stats;
+}
+
+Archetype& World::archetypeFor(ComponentMask mask)
+{
+  auto found = archetypes.find(mask);
+  if (found != archetypes.end())
+  {
+    return *found->second;
+  }
+
+  std::unique_ptr<Archetype> archetype(new Archetype(mask));
+  Archetype* raw = archetype.get();
+  archetypes.emplace(mask, std::move(archetype));
+  archetype_order.push_back(raw);
+  return *raw;
+}
+
+Entity World::allocateEntity()
+{
+  Entity entity;
+  if (!free_indices.empty())
+  {
+    entity.index = free_indices.back();
+    free_indices.pop_back();
+  }
+  else
+  {
+    entity.index = static_cast<std::uint32_t>(records.size());
+    records.emplace_back();
+    records.back().generation = 1;
+  }
+
+  entity.generation = records[entity.index].generation;
+  alive_count++;
+  return entity;
+}
@@ -0,0 +1,317 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+/**
+ *  Handle to an entity stored in a World.
+ *  The generation detects handles to entities that have been destroyed
+ *  and whose slot has since been reused.
+ */
+struct Entity
+{
+  std::uint32_t index = 0;
+  std::uint32_t generation = 0;
+
+  bool operator==(const Entity& rhs) const
+  {
+    return index == rhs.index && generation == rhs.generation;
+  }
+  bool operator!=(const Entity& rhs) const { return !(*this == rhs); }
+};
+
+/** One bit per registered component type. */
+using ComponentMask = std::uint64_t;
+
+/**
+ *  Assigns every component type a small integer id on first use.
+ *  Components are stored as raw bytes, so they must be trivially
+ *  copyable.
+ */
+class ComponentRegistry
+{
+ public:
+  enum
+  {
+    max_components = 64
+  };
+
+  struct Info
+  {
+    std::size_t size = 0;
+    std::size_t align = 0;
+  };
+
+  template<typename T>
+  static std::size_t id()
+  {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "components must be trivially copyable");
+    static const std::size_t type_id = add(Info{ sizeof(T), alignof(T) });
+    return type_id;
+  }
+
+  static const Info& info(std::size_t type_id);
+
+ private:
+  static std::size_t add(Info info);
+};
+
+/**
+ *  Stands in for state kept outside the world, such as a subsystem or a
+ *  counter, so systems can list it in their read and write masks.
+ */
+template<typename T>
+struct Resource
+{
+};
+
+/**
+ *   @brief   Builds the mask for a set of component types.
+ *   @return  A mask with one bit set per component type.
+ */
+template<typename... Ts>
+ComponentMask componentMask()
+{
+  ComponentMask mask = 0;
+  using expand = int[];
+  (void)expand{ 0,
+                (mask |= ComponentMask(1) << ComponentRegistry::id<Ts>(),
+                 0)... };
+  return mask;
+}
+
+/**
+ *  A fixed size block of entities sharing an archetype.
+ *  Each component is stored in its own dense array inside the block.
+ */
+struct Chunk
+{
+  std::unique_ptr<unsigned char[]> data;
+  std::vector<Entity> entities;
+};
+
+/**
+ *  Storage for every entity with exactly the same set of components.
+ */
+class Archetype
+{
+ public:
+  enum
+  {
+    chunk_bytes = 16 * 1024
+  };
+
+  struct Location
+  {
+    std::uint32_t chunk = 0;
+    std::uint32_t row = 0;
+  };
+
+  explicit Archetype(ComponentMask mask);
+
+  ComponentMask getMask() const;
+  std::size_t getChunkCapacity() const;
+  std::size_t size() const;
+  std::vector<Chunk>& getChunks();
+  const std::vector<Chunk>& getChunks() const;
+
+  bool hasComponent(std::size_t type_id) const;
+  void* component(const Location& location, std::size_t type_id);
+
+  template<typename T>
+  T* column(Chunk& chunk)
+  {
+    const auto type_id = ComponentRegistry::id<T>();
+    return reinterpret_cast<T*>(chunk.data.get() +
+                                columns[column_index[type_id]].offset);
+  }
+
+  Location allocate(Entity entity);
+  Entity remove(const Location& location);
+
+ private:
+  struct Column
+  {
+    std::size_t type_id = 0;
+    std::size_t size = 0;
+    std::size_t offset = 0;
+  };
+
+  ComponentMask mask = 0;
+  std::size_t capacity = 0;
+  std::size_t entity_count = 0;
+  std::vector<Column> columns;
+  std::array<std::int8_t, ComponentRegistry::max_components> column_index{};
+  std::vector<Chunk> chunks;
+};
+
+/**
+ *  Archetype based entity-component store.
+ *  Entities with the same component set share chunked, dense storage,
+ *  so iterating a query touches contiguous memory. Structural changes
+ *  must not happen while iterating; use destroyDeferred() from inside
+ *  a query or system and flush() once it has finished.
+ */
+class World
+{
+ public:
+  struct ArchetypeStats
+  {
+    ComponentMask mask = 0;
+    std::size_t entities = 0;
+    std::size_t chunks = 0;
+  };
+
+  World() = default;
+  World(const World&) = delete;
+  World& operator=(const World&) = delete;
+
+  template<typename... Ts>
+  Entity create(const Ts&... components)
+  {
+    Archetype& archetype = archetypeFor(componentMask<Ts...>());
+    const Entity entity = allocateEntity();
+    const auto location = archetype.allocate(entity);
+    records[entity.index] =
+      Record{ &archetype, location, entity.generation };
+
+    using expand = int[];
+    (void)expand{ 0,
+                  (*static_cast<Ts*>(archetype.component(
+                     location, ComponentRegistry::id<Ts>())) = components,
+                   0)... };
+    return entity;
+  }
+
+  void destroy(Entity entity);
+  void destroyDeferred(Entity entity);
+  void flush();
+  void clear();
+
+  bool isAlive(Entity entity) const;
+
+  template<typename T>
+  T* get(Entity entity)
+  {
+    if (!isAlive(entity))
+    {
+      return nullptr;
+    }
+    const Record& record = records[entity.index];
+    const auto type_id = ComponentRegistry::id<T>();
+    if (!record.archetype->hasComponent(type_id))
+    {
+      return nullptr;
+    }
+    return static_cast<T*>(
+      record.archetype->component(record.location, type_id));
+  }
+
+  /**
+   *   @brief   Visits every entity holding all of the given components.
+   *   @details The callable receives the entity followed by a reference
+   *            to each requested component, in the order given.
+   */
+  template<typename... Ts, typename Fn>
+  void each(Fn&& fn)
+  {
+    const ComponentMask required = componentMask<Ts...>();
+    for (Archetype* archetype : archetype_order)
+    {
+      if ((archetype->getMask() & required) != required)
+      {
+        continue;
+      }
+      for (auto& chunk : archetype->getChunks())
+      {
+        visit(fn,
+              chunk.entities.data(),
+              chunk.entities.size(),
+              archetype->column<Ts>(chunk)...);
+      }
+    }
+  }
+
+  /**
+   *   @brief   Visits every chunk holding all of the given components.
+   *   @details The callable receives the chunk's entities, its row count
+   *            and a pointer to each requested column, which allows
+   *            batched and vectorised processing.
+   */
+  template<typename... Ts, typename Fn>
+  void eachChunk(Fn&& fn)
+  {
+    const ComponentMask required = componentMask<Ts...>();
+    for (Archetype* archetype : archetype_order)
+    {
+      if ((archetype->getMask() & required) != required)
+      {
+        continue;
+      }
+      for (auto& chunk : archetype->getChunks())
+      {
+        if (!chunk.entities.empty())
+        {
+          fn(chunk.entities.data(),
+             chunk.entities.size(),
+             archetype->column<Ts>(chunk)...);
+        }
+      }
+    }
+  }
+
+  template<typename... Ts>
+  std::size_t count() const
+  {
+    const ComponentMask required = componentMask<Ts...>();
+    std::size_t total = 0;
+    for (const Archetype* archetype : archetype_order)
+    {
+      if ((archetype->getMask() & required) == required)
+      {
+        total += archetype->size();
+      }
+    }
+    return total;
+  }
+
+  std::size_t entityCount() const;
+  std::size_t archetypeCount() const;
+  std::vector<ArchetypeStats> archetypeStats() const;
+
+ private:
+  struct Record
+  {
+    Archetype* archetype = nullptr;
+    Archetype::Location location;
+    std::uint32_t generation = 0;
+  };
+
+  template<typename Fn, typename... Ts>
+  static void
+  visit(Fn& fn, const Entity* entities, std::size_t rows, Ts*... columns)
+  {
+    for (std::size_t i = 0; i < rows; i++)
+    {
+      fn(entities[i], columns[i]...);
+    }
+  }
+
+  Archetype& archetypeFor(ComponentMask mask);
+  Entity allocateEntity();
+
+  std::unordered_map<ComponentMask, std::unique_ptr<Archetype>> archetypes;
+  std::vector<Archetype*> archetype_order;
+  std::vector<Record> records;
+  std::vector<std::uint32_t> free_indices;
+  std::size_t alive_count = 0;
+
+  std::mutex deferred_mutex;
+  std::vector<Entity> deferred;
+};
@@ -0,0 +1,157 @@
+#include "FileWatcher.h"
+
+#include <cstdint>
+
+#ifdef __linux__
+#  include <poll.h>
+#  include <sys/eventfd.h>
+#  include <sys/inotify.h>
+#  include <unistd.h>
+#endif
+
+/**
+ *   @brief   Constructor.
+ *   @details Opens the inotify instance where available.
+ */
+FileWatcher::FileWatcher()
+{
+#ifdef __linux__
+  inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+#endif
+}
+
+/**
+ *   @brief   Destructor.
+ *   @details Stops the watch thread and releases the descriptors.
+ */
+FileWatcher::~FileWatcher()
+{
+  stop();
+#ifdef __linux__
+  if (inotify_fd >= 0)
+  {
+    close(inotify_fd);
+  }
+  if (wake_fd >= 0)
+  {
+    close(wake_fd);
+  }
+#endif
+}
+
+bool FileWatcher::isSupported()
+{
+#ifdef __linux__
+  return true;
+#else
+  return false;
+#endif
+}
+
+/**
+ *   @brief   Starts watching a directory.
+ *   @details Files are reported when closed after writing or moved in,
+ *            which covers editors that save via a temporary file.
+ *            Subdirectories are not watched.
+ *   @param   directory The directory to watch.
+ *   @return  True if the directory is now being watched.
+ */
+bool FileWatcher::addDirectory(const std::string& directory)
+{
+#ifdef __linux__
+  if (inotify_fd < 0)
+  {
+    return false;
+  }
+
+  const int descriptor = inotify_add_watch(
+    inotify_fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+  if (descriptor < 0)
+  {
+    return false;
+  }
+
+  directories[descriptor] = directory;
+  return true;
+#else
+  (void)directory;
+  return false;
+#endif
+}
+
+/**
+ *   @brief   Starts the watch thread.
+ *   @param   callback Invoked on the watch thread for each change.
+ *   @return  True if the thread was started.
+ */
+bool FileWatcher::start(Callback callback)
+{
+  if (running || inotify_fd < 0 || wake_fd < 0 || directories.empty())
+  {
+    return false;
+  }
+
+  on_change = std::move(callback);
+  running = true;
+  thread = std::thread(&FileWatcher::watchLoop, this);
+  return true;
+}
+
+/**
+ *   @brief   Stops the watch thread and waits for it to finish.
+ *   @return  void
+ */
+void FileWatcher::stop()
+{
+  if (!running)
+  {
+    return;
+  }
+
+  running = false;
+#ifdef __linux__
+  const std::uint64_t wake = 1;
+  if (write(wake_fd, &wake, sizeof(wake)) < 0)
+  {
+    // the poll timeout still ends the loop
+  }
+#endif
+  thread.join();
+}
+
+void FileWatcher::watchLoop()
+{
+#ifdef __linux__
+  alignas(inotify_event) char buffer[4096];
+
+  while (running)
+  {
+    pollfd fds[2] = { { inotify_fd, POLLIN, 0 }, { wake_fd, POLLIN, 0 } };
+    if (poll(fds, 2, 500) <= 0 || !(fds[0].revents & POLLIN))
+    {
+      continue;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    ssize_t length = 0;
+    while ((length = read(inotify_fd, buffer, sizeof(buffer))) > 0)
+    {
+      for (ssize_t offset = 0; offset < length;)
+      {
+        const auto* event = reinterpret_cast<const inotify_event*>(
+          buffer + offset);
+        offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+
+        const auto dir = directories.find(event->wd);
+        if (event->len == 0 || dir == directories.end())
+        {
+          continue;
+        }
+
+        on_change(Event{ dir->second + "/" + event->name, now });
+      }
+    }
+  }
+#endif
+}
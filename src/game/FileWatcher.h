@@ -0,0 +1,45 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <string>
+#include <thread>
+
+/**
+ *  Reports files that have been written in a set of directories.
+ *  Uses inotify on Linux and runs the callback on its own thread. On
+ *  other platforms isSupported() returns false and nothing is reported.
+ */
+class FileWatcher
+{
+ public:
+  struct Event
+  {
+    std::string path; /**< Full path of the file that changed. */
+    std::chrono::steady_clock::time_point time;
+  };
+
+  using Callback = std::function<void(const Event&)>;
+
+  FileWatcher();
+  ~FileWatcher();
+
+  FileWatcher(const FileWatcher&) = delete;
+  FileWatcher& operator=(const FileWatcher&) = delete;
+
+  static bool isSupported();
+  bool addDirectory(const std::string& directory);
+  bool start(Callback callback);
+  void stop();
+
+ private:
+  void watchLoop();
+
+  Callback on_change;
+  std::map<int, std::string> directories; /**< Watch descriptor to path. */
+  std::thread thread;
+  std::atomic<bool> running{ false };
+  int inotify_fd = -1;
+  int wake_fd = -1;
+};
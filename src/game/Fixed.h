@@ -0,0 +1,116 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+
+/**
+ *  Signed Q16.16 fixed point number.
+ *  All arithmetic is integer, so results are bit-identical on every
+ *  compiler and CPU. Multiplication and division widen to 64 bits and
+ *  truncate towards zero. The representable range is about +-32767.
+ */
+class Fixed
+{
+ public:
+  enum
+  {
+    fraction_bits = 16
+  };
+
+  Fixed() = default;
+  constexpr explicit Fixed(int value) : raw_value(value * (1 << fraction_bits))
+  {
+  }
+
+  static constexpr Fixed fromRaw(std::int32_t raw)
+  {
+    return Fixed(raw, RawTag{});
+  }
+
+  /**
+   *   @brief   Converts from floating point, rounding to nearest.
+   *   @details Only use for values known at load time, such as level
+   *            layouts. Exactly representable inputs convert exactly.
+   */
+  static Fixed fromFloat(float value)
+  {
+    return fromRaw(static_cast<std::int32_t>(
+      std::lround(static_cast<double>(value) * (1 << fraction_bits))));
+  }
+
+  constexpr std::int32_t raw() const { return raw_value; }
+  float toFloat() const
+  {
+    return static_cast<float>(raw_value) / (1 << fraction_bits);
+  }
+
+  constexpr Fixed operator-() const { return fromRaw(-raw_value); }
+  constexpr Fixed operator+(Fixed rhs) const
+  {
+    return fromRaw(raw_value + rhs.raw_value);
+  }
+  constexpr Fixed operator-(Fixed rhs) const
+  {
+    return fromRaw(raw_value - rhs.raw_value);
+  }
+  constexpr Fixed operator*(Fixed rhs) const
+  {
+    return fromRaw(static_cast<std::int32_t>(
+      (static_cast<std::int64_t>(raw_value) * rhs.raw_value) >>
+      fraction_bits));
+  }
+  constexpr Fixed operator/(Fixed rhs) const
+  {
+    return fromRaw(static_cast<std::int32_t>(
+      (static_cast<std::int64_t>(raw_value) * (1 << fraction_bits)) /
+      rhs.raw_value));
+  }
+
+  Fixed& operator+=(Fixed rhs)
+  {
+    raw_value += rhs.raw_value;
+    return *this;
+  }
+  Fixed& operator-=(Fixed rhs)
+  {
+    raw_value -= rhs.raw_value;
+    return *this;
+  }
+
+  constexpr bool operator==(Fixed rhs) const
+  {
+    return raw_value == rhs.raw_value;
+  }
+  constexpr bool operator!=(Fixed rhs) const
+  {
+    return raw_value != rhs.raw_value;
+  }
+  constexpr bool operator<(Fixed rhs) const
+  {
+    return raw_value < rhs.raw_value;
+  }
+  constexpr bool operator>(Fixed rhs) const
+  {
+    return raw_value > rhs.raw_value;
+  }
+  constexpr bool operator<=(Fixed rhs) const
+  {
+    return raw_value <= rhs.raw_value;
+  }
+  constexpr bool operator>=(Fixed rhs) const
+  {
+    return raw_value >= rhs.raw_value;
+  }
+
+ private:
+  struct RawTag
+  {
+  };
+  constexpr Fixed(std::int32_t raw, RawTag) : raw_value(raw) {}
+
+  std::int32_t raw_value = 0;
+};
+
+inline Fixed abs(Fixed value)
+{
+  return value.raw() < 0 ? -value : value;
+}
@@ -0,0 +1,175 @@
+#include "FramePipeline.h"
+
+#include <chrono>
+#include <utility>
+
+namespace
+{
+  /** Weight of the newest frame in the averages. */
+  const double smoothing = 0.05;
+
+  double elapsedMs(std::chrono::steady_clock::time_point since)
+  {
+    const std::chrono::duration<double, std::milli> elapsed =
+      std::chrono::steady_clock::now() - since;
+    return elapsed.count();
+  }
+
+  void smooth(double& average, double sample)
+  {
+    average += (sample - average) * smoothing;
+  }
+}
+
+/**
+ *   @brief   Constructor.
+ *   @details Starts unpipelined, with no worker thread.
+ *   @param   work_fn Advances the simulation and captures a snapshot.
+ */
+FramePipeline::FramePipeline(Work work_fn) : work(std::move(work_fn)) {}
+
+FramePipeline::~FramePipeline()
+{
+  setPipelined(false);
+}
+
+/**
+ *   @brief   Moves the work on to or off a worker thread.
+ *   @details Any work in flight finishes first.
+ *   @param   enabled Whether to run the work on a worker.
+ *   @return  void
+ */
+void FramePipeline::setPipelined(bool enabled)
+{
+  finish();
+  if (enabled == isPipelined())
+  {
+    return;
+  }
+
+  if (enabled)
+  {
+    requested.store(0);
+    completed.store(0);
+    stopping.store(false);
+    worker = std::thread(&FramePipeline::workerLoop, this);
+    return;
+  }
+
+  stopping.store(true, std::memory_order_release);
+  requested.fetch_add(1, std::memory_order_release);
+  requested.notify_one();
+  worker.join();
+}
+
+bool FramePipeline::isPipelined() const
+{
+  return worker.joinable();
+}
+
+/**
+ *   @brief   Waits for the work started last frame.
+ *   @details Once it returns the simulation is idle, so the main thread
+ *            may change it, and its snapshot is now the front.
+ *   @return  void
+ */
+void FramePipeline::finish()
+{
+  last_wait_ms = 0;
+  if (!in_flight)
+  {
+    return;
+  }
+
+  const auto start_time = std::chrono::steady_clock::now();
+  const auto target = requested.load(std::memory_order_relaxed);
+  auto done = completed.load(std::memory_order_acquire);
+  while (done != target)
+  {
+    completed.wait(done, std::memory_order_acquire);
+    done = completed.load(std::memory_order_acquire);
+  }
+  last_wait_ms = elapsedMs(start_time);
+
+  in_flight = false;
+  front_index = 1 - front_index;
+  smooth(stats.work_ms, last_work_ms);
+}
+
+/**
+ *   @brief   Starts the work for the next frame.
+ *   @details Pipelined, the work is handed to the worker and its
+ *            snapshot is drawn next frame. Otherwise it runs now and
+ *            its snapshot is drawn this frame.
+ *   @return  void
+ */
+void FramePipeline::start()
+{
+  if (!isPipelined())
+  {
+    runWork();
+    front_index = 1 - front_index;
+    smooth(stats.work_ms, last_work_ms);
+    return;
+  }
+
+  in_flight = true;
+  requested.fetch_add(1, std::memory_order_release);
+  requested.notify_one();
+}
+
+/**
+ *   @brief   The snapshot to draw this frame.
+ *   @details Stays unchanged until the next finish() or start().
+ *   @return  The front snapshot.
+ */
+const FrameSnapshot& FramePipeline::front() const
+{
+  return snapshots[front_index];
+}
+
+/**
+ *   @brief   Adds a frame to the averages.
+ *   @param   frame_ms The time between the starts of two frames.
+ *   @param   main_ms The main thread's time in update and render,
+ *            including any wait in finish().
+ *   @return  void
+ */
+void FramePipeline::recordFrame(double frame_ms, double main_ms)
+{
+  smooth(stats.frame_ms, frame_ms);
+  smooth(stats.main_ms, main_ms - last_wait_ms);
+  smooth(stats.wait_ms, last_wait_ms);
+}
+
+FramePipeline::Stats FramePipeline::getStats() const
+{
+  return stats;
+}
+
+void FramePipeline::workerLoop()
+{
+  std::uint32_t seen = 0;
+  for (;;)
+  {
+    requested.wait(seen, std::memory_order_acquire);
+    if (stopping.load(std::memory_order_acquire))
+    {
+      return;
+    }
+
+    seen = requested.load(std::memory_order_acquire);
+    runWork();
+    completed.store(seen, std::memory_order_release);
+    completed.notify_one();
+  }
+}
+
+void FramePipeline::runWork()
+{
+  const auto start_time = std::chrono::steady_clock::now();
+  auto& back = snapshots[1 - front_index];
+  work(back);
+  back.sequence = ++sequence;
+  last_work_ms = elapsedMs(start_time);
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <thread>
+
+#include "FrameSnapshot.h"
+
+/**
+ *  Runs the simulation of the next frame while this one is drawn.
+ *  The work, advancing the simulation and capturing a snapshot, writes
+ *  into the back of a pair of snapshots while the main thread draws
+ *  the front. Pipelined, the work runs on a worker thread and is handed
+ *  over through atomic counters, with no locks; otherwise it runs
+ *  inline and its snapshot is drawn in the same frame.
+ */
+class FramePipeline
+{
+ public:
+  using Work = std::function<void(FrameSnapshot&)>;
+
+  /** Averages over recent frames, in milliseconds. */
+  struct Stats
+  {
+    double frame_ms = 0;
+    double main_ms = 0; /**< Main thread busy, not waiting on the work. */
+    double wait_ms = 0; /**< Main thread waiting on the work. */
+    double work_ms = 0;
+  };
+
+  explicit FramePipeline(Work work_fn);
+  ~FramePipeline();
+
+  FramePipeline(const FramePipeline&) = delete;
+  FramePipeline& operator=(const FramePipeline&) = delete;
+
+  void setPipelined(bool enabled);
+  bool isPipelined() const;
+
+  void finish();
+  void start();
+  const FrameSnapshot& front() const;
+
+  void recordFrame(double frame_ms, double main_ms);
+  Stats getStats() const;
+
+ private:
+  void workerLoop();
+  void runWork();
+
+  Work work;
+  std::array<FrameSnapshot, 2> snapshots;
+  std::size_t front_index = 0;
+  std::uint64_t sequence = 0;
+
+  std::thread worker;
+  std::atomic<std::uint32_t> requested{ 0 };
+  std::atomic<std::uint32_t> completed{ 0 };
+  std::atomic<bool> stopping{ false };
+  bool in_flight = false;
+
+  double last_work_ms = 0; /**< Written by the work, read once it is done. */
+  double last_wait_ms = 0;
+  Stats stats;
+};
@@ -0,0 +1,17 @@
+#include "FrameSnapshot.h"
+
+#include <algorithm>
+
+/**
+ *   @brief   Predicts how far the paddle moves before it is next drawn.
+ *   @details Extrapolates the velocity over the time not yet simulated
+ *            plus the given time, clamped to the play area.
+ *   @param   seconds Time since the state was captured.
+ *   @return  The horizontal offset in game units.
+ */
+float PaddleState::offsetAfter(double seconds) const
+{
+  const float ahead =
+    static_cast<float>(static_cast<double>(velocity) * (unsimulated + seconds));
+  return std::clamp(x + ahead, 0.0F, std::max(max_x, 0.0F)) - x;
+}
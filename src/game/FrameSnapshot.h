@@ -0,0 +1,99 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ScriptScheduler.h"
+#include "SystemScheduler.h"
+#include "Textures.h"
+
+/** A sprite to draw, in game units. */
+struct DrawItem
+{
+  TextureId texture = TextureId::BALL;
+  float x = 0;
+  float y = 0;
+  float w = 0;
+  float h = 0;
+  bool latched = false; /**< Moves with the late latched paddle. */
+};
+
+/** Where the paddle is and how it is moving, to draw it ahead. */
+struct PaddleState
+{
+  float x = 0;
+  float max_x = 0;
+  float speed = 0;
+  float velocity = 0;
+  double unsimulated = 0; /**< Time accumulated but not yet stepped. */
+
+  float offsetAfter(double seconds) const;
+};
+
+/** Something the ball bounces off on its way to the paddle line. */
+struct BallContact
+{
+  enum class Kind : std::uint8_t
+  {
+    LEFT_WALL,
+    RIGHT_WALL,
+    CEILING,
+    BRICK,
+    ARENA_BRICK
+  };
+
+  Kind kind = Kind::LEFT_WALL;
+  std::uint64_t step = 0; /**< The fixed step that bounces the ball. */
+  float x = 0;            /**< Top left of the ball at that step. */
+  float y = 0;
+  int column = -1; /**< The brick, or -1 for a wall. */
+  int row = -1;
+};
+
+/** The ball's path from where it is to the paddle line. */
+struct BallPrediction
+{
+  std::vector<BallContact> contacts; /**< In the order they happen. */
+  bool lands = false; /**< False if the path was cut short. */
+  std::uint64_t landing_step = 0;
+  float landing_x = 0; /**< The centre of the ball on the paddle line. */
+  float landing_y = 0; /**< The top of the ball on the paddle line. */
+};
+
+/**
+ *  Running totals since the simulation was created. They never go
+ *  down, even across restarts, so they can be exported as counters.
+ */
+struct SimulationTotals
+{
+  std::uint64_t collision_tests = 0; /**< Ball against paddle or brick. */
+  std::uint64_t bricks_destroyed = 0;
+  std::uint64_t lives_lost = 0;
+  std::uint64_t points = 0;
+};
+
+/**
+ *  Everything render() needs from the simulation, copied out after it
+ *  advances. Drawing only ever reads a snapshot, so the simulation can
+ *  move on to the next frame while this one is drawn.
+ */
+struct FrameSnapshot
+{
+  std::uint64_t sequence = 0;
+  std::uint64_t input = 0; /**< Newest input applied before the work. */
+  int steps = 0;          /**< Fixed steps run to reach this state. */
+  double captured_at = 0; /**< Seconds, on the steady clock. */
+
+  std::vector<DrawItem> items; /**< In draw order. */
+  PaddleState paddle;
+  int lives = 0;
+  int score = 0;
+  SimulationTotals totals;
+  BallPrediction prediction;
+
+  std::size_t entities = 0;
+  std::size_t archetypes = 0;
+  std::size_t stages = 0;
+  ScriptScheduler::Stats scripts;
+  std::vector<SystemScheduler::Timing> timings;
+};
@@ -0,0 +1,96 @@
+#include "GameMetrics.h"
+
+namespace
+{
+  /** 0.25ms to 128ms, which covers 1000Hz down to a badly stalled frame. */
+  std::vector<double> frameBuckets()
+  {
+    return Histogram::exponentialBuckets(0.00025, 2, 10);
+  }
+}
+
+/**
+ *   @brief   Constructor.
+ *   @details Registers every metric up front, so recording never
+ *            touches the registry's lock.
+ */
+GameMetrics::GameMetrics() :
+  frame_seconds(registry.histogram(
+    "breakout_frame_seconds", "Time between frames.", frameBuckets())),
+  update_seconds(registry.histogram("breakout_update_seconds",
+                                    "Main thread time spent in update.",
+                                    frameBuckets())),
+  render_seconds(registry.histogram("breakout_render_seconds",
+                                    "Main thread time spent in render.",
+                                    frameBuckets())),
+  asset_load_seconds(
+    registry.histogram("breakout_asset_load_seconds",
+                       "Time to load each texture.",
+                       Histogram::exponentialBuckets(0.0001, 4, 8))),
+  main_thread_ratio(
+    registry.gauge("breakout_main_thread_ratio",
+                   "Share of the last frame spent in update and render.")),
+  collision_tests(
+    registry.counter("breakout_collision_tests_total",
+                     "Ball tests against the paddle and bricks.")),
+  bricks_destroyed(registry.counter("breakout_bricks_destroyed_total",
+                                    "Bricks destroyed.")),
+  lives_lost(registry.counter("breakout_lives_lost_total", "Lives lost.")),
+  points(registry.counter("breakout_points_total", "Points scored.")),
+  lives(registry.gauge("breakout_lives", "Lives left in the current game.")),
+  score(registry.gauge("breakout_score", "Score in the current game."))
+{
+}
+
+/**
+ *   @brief   Records one frame's times.
+ *   @param   frame_ms The time from the start of the last frame to the
+ *            start of this one.
+ *   @param   update_ms The main thread's time in update().
+ *   @param   render_ms The main thread's time in render().
+ *   @return  void
+ */
+void GameMetrics::recordFrame(double frame_ms,
+                              double update_ms,
+                              double render_ms)
+{
+  frame_seconds.observe(frame_ms / 1000);
+  update_seconds.observe(update_ms / 1000);
+  render_seconds.observe(render_ms / 1000);
+  if (frame_ms > 0)
+  {
+    main_thread_ratio.set((update_ms + render_ms) / frame_ms);
+  }
+}
+
+/**
+ *   @brief   Records what happened in the simulation since the last
+ *            snapshot.
+ *   @details The simulation keeps running totals, so the counters take
+ *            the difference from the last snapshot seen.
+ *   @param   snapshot A snapshot newer than the last one recorded.
+ *   @return  void
+ */
+void GameMetrics::recordSnapshot(const FrameSnapshot& snapshot)
+{
+  const auto& totals = snapshot.totals;
+  collision_tests.add(totals.collision_tests - last_totals.collision_tests);
+  bricks_destroyed.add(totals.bricks_destroyed -
+                       last_totals.bricks_destroyed);
+  lives_lost.add(totals.lives_lost - last_totals.lives_lost);
+  points.add(totals.points - last_totals.points);
+  last_totals = totals;
+
+  lives.set(snapshot.lives);
+  score.set(snapshot.score);
+}
+
+void GameMetrics::recordAssetLoad(double load_ms)
+{
+  asset_load_seconds.observe(load_ms / 1000);
+}
+
+const MetricsRegistry& GameMetrics::getRegistry() const
+{
+  return registry;
+}
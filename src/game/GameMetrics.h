@@ -0,0 +1,41 @@
+#pragma once
+#include <cstdint>
+
+#include "FrameSnapshot.h"
+#include "Metrics.h"
+
+/**
+ *  The metrics the game exports, fed from the game loop.
+ *  Times are exported in seconds and totals as counters, so rates such
+ *  as bricks destroyed per second come from Prometheus' rate() rather
+ *  than being averaged here.
+ */
+class GameMetrics
+{
+ public:
+  GameMetrics();
+
+  void recordFrame(double frame_ms, double update_ms, double render_ms);
+  void recordSnapshot(const FrameSnapshot& snapshot);
+  void recordAssetLoad(double load_ms);
+
+  const MetricsRegistry& getRegistry() const;
+
+ private:
+  MetricsRegistry registry;
+
+  Histogram& frame_seconds;
+  Histogram& update_seconds;
+  Histogram& render_seconds;
+  Histogram& asset_load_seconds;
+  Gauge& main_thread_ratio;
+
+  Counter& collision_tests;
+  Counter& bricks_destroyed;
+  Counter& lives_lost;
+  Counter& points;
+  Gauge& lives;
+  Gauge& score;
+
+  SimulationTotals last_totals;
+};
@@ -0,0 +1,259 @@
+#include "HotReloader.h"
+
+#include <algorithm>
+#include <fstream>
+
+#ifdef __linux__
+#  include <climits>
+#  include <unistd.h>
+#endif
+
+/**
+ *   @brief   Constructor.
+ *   @param   data_directory The real path of the game's data folder.
+ *   @param   level_path The level file, relative to data_directory.
+ */
+HotReloader::HotReloader(std::string data_directory, std::string level_path) :
+  data_dir(std::move(data_directory)),
+  level_file(std::move(level_path))
+{
+}
+
+HotReloader::~HotReloader()
+{
+  stop();
+}
+
+/**
+ *   @brief   The data folder next to the running executable.
+ *   @return  The directory, or "data" if it cannot be determined.
+ */
+std::string HotReloader::defaultDataDirectory()
+{
+#ifdef __linux__
+  char path[PATH_MAX];
+  const auto length = readlink("/proc/self/exe", path, sizeof(path) - 1);
+  if (length > 0)
+  {
+    std::string exe(path, static_cast<std::size_t>(length));
+    return exe.substr(0, exe.find_last_of('/')) + "/data";
+  }
+#endif
+  return "data";
+}
+
+/**
+ *   @brief   Fingerprints the watched files and starts watching.
+ *   @param   current_level The level the game is currently running.
+ *   @return  False if file watching is unavailable.
+ */
+bool HotReloader::start(const LevelData& current_level)
+{
+  level = current_level;
+
+  std::string contents;
+  for (std::size_t i = 0; i < textureIndex(TextureId::COUNT); i++)
+  {
+    const auto& info = textureInfo(static_cast<TextureId>(i));
+    contentChanged("images/" + std::string(info.name) + ".png", contents);
+  }
+  contentChanged(level_file, contents);
+
+  const auto level_dir = level_file.substr(0, level_file.find_last_of('/'));
+  if (!watcher.addDirectory(data_dir + "/images") ||
+      !watcher.addDirectory(data_dir + "/" + level_dir))
+  {
+    return false;
+  }
+
+  return watcher.start(
+    [this](const FileWatcher::Event& event) { onFileChanged(event); });
+}
+
+void HotReloader::stop()
+{
+  watcher.stop();
+}
+
+/**
+ *   @brief   Hands over every reload prepared since the last call.
+ *   @details Called by the game between frames.
+ *   @return  The textures and level patches to swap in.
+ */
+HotReloader::Pending HotReloader::takePending()
+{
+  Pending taken;
+  std::lock_guard<std::mutex> lock(mutex);
+  std::swap(taken, pending);
+  return taken;
+}
+
+/**
+ *   @brief   Records that a reload has been swapped in.
+ *   @param   detected When the change was first seen.
+ *   @param   chunks Level rows respawned, or zero for a texture.
+ *   @return  void
+ */
+void HotReloader::reportApplied(Clock::time_point detected, std::size_t chunks)
+{
+  const std::chrono::duration<double, std::milli> latency =
+    Clock::now() - detected;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  if (chunks == 0)
+  {
+    stats.textures_reloaded++;
+  }
+  stats.level_chunks_reloaded += chunks;
+  stats.last_latency_ms = latency.count();
+  stats.max_latency_ms = std::max(stats.max_latency_ms, latency.count());
+}
+
+void HotReloader::reportFailed()
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  stats.failed++;
+}
+
+const std::string& HotReloader::getDataDirectory() const
+{
+  return data_dir;
+}
+
+HotReloader::Stats HotReloader::getStats() const
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  return stats;
+}
+
+/**
+ *   @brief   Prepares the reload for a changed file.
+ *   @details Runs on the watcher thread. Files the game does not use
+ *            and files whose contents are unchanged are ignored.
+ *   @return  void
+ */
+void HotReloader::onFileChanged(const FileWatcher::Event& event)
+{
+  if (event.path.compare(0, data_dir.size() + 1, data_dir + "/") != 0)
+  {
+    return;
+  }
+  const auto file = event.path.substr(data_dir.size() + 1);
+
+  std::size_t texture = 0;
+  for (; texture < textureIndex(TextureId::COUNT); texture++)
+  {
+    const auto& info = textureInfo(static_cast<TextureId>(texture));
+    if (file == "images/" + std::string(info.name) + ".png")
+    {
+      break;
+    }
+  }
+
+  const bool is_texture = texture < textureIndex(TextureId::COUNT);
+  if (!is_texture && file != level_file)
+  {
+    return;
+  }
+
+  std::string contents;
+  if (!contentChanged(file, contents))
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stats.unchanged_skipped++;
+    return;
+  }
+
+  if (is_texture)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    const auto id = static_cast<TextureId>(texture);
+    const bool queued = std::any_of(
+      pending.textures.begin(),
+      pending.textures.end(),
+      [id](const TextureReload& reload) { return reload.texture == id; });
+    if (!queued)
+    {
+      pending.textures.push_back(TextureReload{ id, file, event.time });
+    }
+    return;
+  }
+
+  LevelReload reload;
+  std::string error;
+  if (!parseLevel(contents, reload.level, error))
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stats.failed++;
+    return;
+  }
+
+  reload.diff = diffLevels(level, reload.level);
+  reload.detected = event.time;
+  level = reload.level;
+  if (!reload.diff.empty())
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    pending.levels.push_back(std::move(reload));
+  }
+}
+
+/**
+ *   @brief   Reads a file and compares it with its last fingerprint.
+ *   @param   file Path relative to the data directory.
+ *   @param   contents Receives the file's contents.
+ *   @return  True if the file is readable and differs from last time.
+ */
+bool HotReloader::contentChanged(const std::string& file,
+                                 std::string& contents)
+{
+  if (!readFile(data_dir + "/" + file, contents))
+  {
+    return false;
+  }
+
+  const auto fingerprint = hash(contents);
+  auto found = fingerprints.find(file);
+  if (found != fingerprints.end() && found->second == fingerprint)
+  {
+    return false;
+  }
+
+  fingerprints[file] = fingerprint;
+  return true;
+}
+
+/**
+ *   @brief   Reads a whole file.
+ *   @details Sized up front and read in one call.
+ *   @return  False if the file could not be read.
+ */
+bool HotReloader::readFile(const std::string& path, std::string& contents)
+{
+  std::ifstream stream(path, std::ios::binary | std::ios::ate);
+  const auto length = stream.tellg();
+  if (!stream || length < 0)
+  {
+    return false;
+  }
+
+  contents.resize(static_cast<std::size_t>(length));
+  stream.seekg(0);
+  return static_cast<bool>(
+    stream.read(&contents[0], static_cast<std::streamsize>(length)));
+}
+
+/**
+ *   @brief   64 bit FNV-1a hash.
+ *   @return  The hash of the given bytes.
+ */
+std::uint64_t HotReloader::hash(const std::string& contents)
+{
+  std::uint64_t value = 14695981039346656037ULL;
+  for (unsigned char byte : contents)
+  {
+    value ^= byte;
+    value *= 1099511628211ULL;
+  }
+  return value;
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "FileWatcher.h"
+#include "Level.h"
+#include "Textures.h"
+
+/**
+ *  Watches the game's data directory and prepares reloads of edited
+ *  textures and levels.
+ *  Changes are detected, read, hashed and parsed on the watcher's
+ *  thread. Files whose contents have not changed are dropped there, so
+ *  an unchanged asset is never reloaded. The game collects the prepared
+ *  reloads between frames with takePending() and reports each one once
+ *  it has been swapped in, which measures the reload latency.
+ */
+class HotReloader
+{
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  struct TextureReload
+  {
+    TextureId texture = TextureId::BALL;
+    std::string file; /**< Relative to the data directory. */
+    Clock::time_point detected;
+  };
+
+  struct LevelReload
+  {
+    LevelData level;
+    LevelDiff diff;
+    Clock::time_point detected;
+  };
+
+  struct Pending
+  {
+    std::vector<TextureReload> textures;
+    std::vector<LevelReload> levels;
+
+    bool empty() const { return textures.empty() && levels.empty(); }
+  };
+
+  struct Stats
+  {
+    std::size_t textures_reloaded = 0;
+    std::size_t level_chunks_reloaded = 0;
+    std::size_t unchanged_skipped = 0;
+    std::size_t failed = 0;
+    double last_latency_ms = 0;
+    double max_latency_ms = 0;
+  };
+
+  HotReloader(std::string data_directory, std::string level_path);
+  ~HotReloader();
+
+  static std::string defaultDataDirectory();
+
+  bool start(const LevelData& current_level);
+  void stop();
+
+  Pending takePending();
+  void reportApplied(Clock::time_point detected, std::size_t chunks);
+  void reportFailed();
+
+  const std::string& getDataDirectory() const;
+  Stats getStats() const;
+
+ private:
+  void onFileChanged(const FileWatcher::Event& event);
+  bool contentChanged(const std::string& file, std::string& contents);
+
+  static bool readFile(const std::string& path, std::string& contents);
+  static std::uint64_t hash(const std::string& contents);
+
+  std::string data_dir;
+  std::string level_file;
+  FileWatcher watcher;
+
+  // only touched by the watcher thread once started
+  std::unordered_map<std::string, std::uint64_t> fingerprints;
+  LevelData level;
+
+  mutable std::mutex mutex;
+  Pending pending;
+  Stats stats;
+};
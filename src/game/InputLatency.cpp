@@ -0,0 +1,169 @@
+#include "InputLatency.h"
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+/**
+ *   @brief   Constructor.
+ *   @param   clock_fn Returns the current time in seconds.
+ */
+InputLatency::InputLatency(Clock clock_fn) : clock(std::move(clock_fn)) {}
+
+double InputLatency::steadyClock()
+{
+  const std::chrono::duration<double> now =
+    std::chrono::steady_clock::now().time_since_epoch();
+  return now.count();
+}
+
+/**
+ *   @brief   Timestamps an input as it arrives.
+ *   @return  void
+ */
+void InputLatency::onInput()
+{
+  Pending input;
+  input.sequence = ++inputs;
+  input.arrival = clock();
+  pending.push_back(input);
+}
+
+/**
+ *   @brief   The sequence of the newest input, or zero before any.
+ *   @details Work tagged with it can later mark what it consumed.
+ *   @return  The sequence.
+ */
+std::uint64_t InputLatency::getLatestInput() const
+{
+  return inputs;
+}
+
+/**
+ *   @brief   Marks every waiting input as used by the game.
+ *   @details Called once the late latch has consumed the newest input.
+ *   @return  void
+ */
+void InputLatency::markApplied()
+{
+  markApplied(inputs);
+}
+
+/**
+ *   @brief   Marks the inputs some work consumed as used by the game.
+ *   @details Called once a simulation step's result is shown. Inputs
+ *            that arrived after the work was started stay waiting.
+ *   @param   latest The newest input the work had applied.
+ *   @return  void
+ */
+void InputLatency::markApplied(std::uint64_t latest)
+{
+  const double now = clock();
+  for (auto& input : pending)
+  {
+    if (input.applied < 0 && input.sequence <= latest)
+    {
+      input.applied = now;
+      record(Stage::APPLIED, now - input.arrival);
+    }
+  }
+}
+
+/**
+ *   @brief   Marks applied inputs as part of a finished draw list.
+ *   @return  void
+ */
+void InputLatency::markSubmitted()
+{
+  const double now = clock();
+  for (auto& input : pending)
+  {
+    if (input.applied >= 0 && input.submitted < 0)
+    {
+      input.submitted = now;
+      record(Stage::SUBMITTED, now - input.arrival);
+    }
+  }
+}
+
+/**
+ *   @brief   Completes every input whose frame has been swapped.
+ *   @details ASGE swaps inside the engine loop, so the game calls this
+ *            at the start of the next frame, when the swap has returned.
+ *   @return  void
+ */
+void InputLatency::markDisplayed()
+{
+  const double now = clock();
+  for (const auto& input : pending)
+  {
+    if (input.submitted >= 0)
+    {
+      record(Stage::DISPLAYED, now - input.arrival);
+    }
+  }
+
+  pending.erase(
+    std::remove_if(pending.begin(),
+                   pending.end(),
+                   [](const Pending& input) { return input.submitted >= 0; }),
+    pending.end());
+}
+
+/**
+ *   @brief   Latency percentiles for a stage.
+ *   @details Uses the nearest rank over the most recent inputs.
+ *   @param   stage How far through the pipeline to measure.
+ *   @return  The percentiles in milliseconds.
+ */
+InputLatency::Percentiles InputLatency::getPercentiles(Stage stage) const
+{
+  auto sorted = samples[static_cast<std::size_t>(stage)];
+  Percentiles result;
+  result.count = sorted.size();
+  if (sorted.empty())
+  {
+    return result;
+  }
+
+  std::sort(sorted.begin(), sorted.end());
+  const auto rank = [&sorted](double percent) {
+    const auto index = static_cast<std::size_t>(
+      percent / 100.0 * static_cast<double>(sorted.size() - 1) + 0.5);
+    return sorted[index] * 1000.0;
+  };
+  result.p50_ms = rank(50);
+  result.p90_ms = rank(90);
+  result.p99_ms = rank(99);
+  result.max_ms = sorted.back() * 1000.0;
+  return result;
+}
+
+std::size_t InputLatency::getPending() const
+{
+  return pending.size();
+}
+
+void InputLatency::reset()
+{
+  pending.clear();
+  for (auto& stage : samples)
+  {
+    stage.clear();
+  }
+  next.fill(0);
+}
+
+void InputLatency::record(Stage stage, double seconds)
+{
+  const auto index = static_cast<std::size_t>(stage);
+  auto& stage_samples = samples[index];
+  if (stage_samples.size() < window)
+  {
+    stage_samples.push_back(seconds);
+    return;
+  }
+
+  stage_samples[next[index]] = seconds;
+  next[index] = (next[index] + 1) % window;
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+/**
+ *  Measures how long player input takes to reach the screen.
+ *  Each input is timestamped when it arrives and then follows the frame
+ *  pipeline: applied, when the simulation or the late latch first uses
+ *  it; submitted, when the frame's draw list is complete; and displayed,
+ *  when that frame has been swapped. Inputs are numbered as they
+ *  arrive, so work that ran on older input only marks that input
+ *  applied. The clock can be replaced, so the measurements can be
+ *  driven headless with synthetic input.
+ */
+class InputLatency
+{
+ public:
+  using Clock = std::function<double()>; /**< Returns seconds. */
+
+  enum class Stage
+  {
+    APPLIED,
+    SUBMITTED,
+    DISPLAYED,
+    COUNT
+  };
+
+  struct Percentiles
+  {
+    std::size_t count = 0;
+    double p50_ms = 0;
+    double p90_ms = 0;
+    double p99_ms = 0;
+    double max_ms = 0;
+  };
+
+  enum
+  {
+    window = 1024 /**< Latencies kept per stage. */
+  };
+
+  explicit InputLatency(Clock clock_fn = steadyClock);
+
+  static double steadyClock();
+
+  void onInput();
+  std::uint64_t getLatestInput() const;
+  void markApplied();
+  void markApplied(std::uint64_t latest);
+  void markSubmitted();
+  void markDisplayed();
+
+  Percentiles getPercentiles(Stage stage) const;
+  std::size_t getPending() const;
+  void reset();
+
+ private:
+  struct Pending
+  {
+    std::uint64_t sequence = 0;
+    double arrival = 0;
+    double applied = -1;
+    double submitted = -1;
+  };
+
+  void record(Stage stage, double seconds);
+
+  Clock clock;
+  std::vector<Pending> pending;
+  std::uint64_t inputs = 0; /**< Inputs seen, the newest's sequence. */
+  std::array<std::vector<double>, static_cast<std::size_t>(Stage::COUNT)>
+    samples;
+  std::array<std::size_t, static_cast<std::size_t>(Stage::COUNT)> next{};
+};
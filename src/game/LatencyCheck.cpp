@@ -0,0 +1,202 @@
+#include "LatencyCheck.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+
+#include "FramePipeline.h"
+#include "InputLatency.h"
+#include "Simulation.h"
+
+namespace
+{
+  enum
+  {
+    frames = 4000,
+    min_input_gap_ms = 20,
+    max_input_gap_ms = 150
+  };
+
+  /** The modelled cost of each part of a frame. */
+  const double update_seconds = 0.002;
+  const double render_seconds = 0.003;
+
+  /** Small deterministic generator, so every run sees the same input. */
+  struct Lcg
+  {
+    std::uint32_t state = 12345;
+
+    int next(int range)
+    {
+      state = state * 1664525U + 1013904223U;
+      return static_cast<int>((state >> 8) % static_cast<std::uint32_t>(range));
+    }
+  };
+
+  struct Result
+  {
+    InputLatency::Percentiles applied;
+    InputLatency::Percentiles displayed;
+    float max_offset = 0; /**< Furthest the paddle was latched ahead. */
+  };
+
+  /**
+   *   @brief   Plays synthetic input through a modelled frame loop.
+   *   @details Mirrors Breakout: the swap completes at the start of each
+   *            frame, input callbacks run when it is polled, the queued
+   *            input is applied, the simulation advances through a
+   *            FramePipeline and then the front snapshot is drawn. A late
+   *            latch only moves where the paddle is drawn; the simulation
+   *            sees the input next frame. Inputs are timestamped when
+   *            they were generated, so the time spent waiting for the
+   *            poll is included. The clock is only read on this thread.
+   *   @param   frame_hz The display refresh rate.
+   *   @param   late_latch Whether input is polled again before drawing.
+   *   @param   pipelined Whether the simulation runs on the worker.
+   *   @return  The latency percentiles and the largest late latch.
+   */
+  Result playFrames(double frame_hz, bool late_latch, bool pipelined)
+  {
+    double now = 0;
+    InputLatency latency([&now] { return now; });
+
+    Simulation simulation;
+    simulation.reset(1280, 720);
+
+    Lcg random;
+    const int directions[] = { -1, 0, 1, 0 };
+    int next_direction = 0;
+    double next_input = 0;
+    int paddle_direction = 0;
+    bool paddle_changed = false;
+
+    const double period = 1.0 / frame_hz;
+    std::uint64_t work_input = 0;
+    double work_started = 0;
+    FramePipeline pipeline([&](FrameSnapshot& snapshot) {
+      snapshot.steps = simulation.advance(period);
+      snapshot.paddle = simulation.getPaddleState();
+      snapshot.captured_at = work_started;
+      snapshot.input = work_input;
+    });
+    pipeline.setPipelined(pipelined);
+    std::uint64_t applied_sequence = 0;
+
+    const auto poll = [&](double poll_time) {
+      while (next_input <= poll_time)
+      {
+        now = next_input;
+        latency.onInput();
+        paddle_direction = directions[next_direction];
+        paddle_changed = true;
+        next_direction = (next_direction + 1) % 4;
+        next_input += (min_input_gap_ms +
+                       random.next(max_input_gap_ms - min_input_gap_ms)) /
+                      1000.0;
+      }
+      now = poll_time;
+    };
+
+    Result result;
+    for (int frame = 0; frame < frames; frame++)
+    {
+      now = frame * period;
+      latency.markDisplayed();
+      poll(now);
+      pipeline.finish();
+      if (paddle_changed)
+      {
+        paddle_changed = false;
+        simulation.setPaddleDirection(paddle_direction);
+      }
+      work_input = latency.getLatestInput();
+      work_started = now;
+      pipeline.start();
+
+      now += update_seconds;
+      const auto& snapshot = pipeline.front();
+      if (snapshot.sequence != applied_sequence)
+      {
+        applied_sequence = snapshot.sequence;
+        if (snapshot.steps > 0 && !late_latch)
+        {
+          latency.markApplied(snapshot.input);
+        }
+      }
+
+      if (late_latch)
+      {
+        poll(now);
+        auto paddle = snapshot.paddle;
+        paddle.velocity = static_cast<float>(paddle_direction) * paddle.speed;
+        const float offset = paddle.offsetAfter(now - snapshot.captured_at);
+        result.max_offset = std::max(result.max_offset, std::fabs(offset));
+        latency.markApplied();
+      }
+
+      now += render_seconds;
+      latency.markSubmitted();
+    }
+    pipeline.finish();
+
+    result.applied = latency.getPercentiles(InputLatency::Stage::APPLIED);
+    result.displayed = latency.getPercentiles(InputLatency::Stage::DISPLAYED);
+    return result;
+  }
+
+  void printResult(double frame_hz, const char* mode, const Result& result)
+  {
+    std::printf("latency %3.0f Hz %-10s applied p50 %6.2f p99 %6.2f  "
+                "displayed p50 %6.2f p99 %6.2f max %6.2f ms  "
+                "latched %.2f\n",
+                frame_hz,
+                mode,
+                result.applied.p50_ms,
+                result.applied.p99_ms,
+                result.displayed.p50_ms,
+                result.displayed.p99_ms,
+                result.displayed.max_ms,
+                static_cast<double>(result.max_offset));
+  }
+}
+
+/**
+ *   @brief   Compares stepped, pipelined and late latched paddle input.
+ *   @details Runs at 60 Hz and at 144 Hz, where some frames run no
+ *            fixed step at all. Late latching must lower the median
+ *            latency to the display at both rates. Pipelined, the front
+ *            snapshot ran before this frame's input was applied, so the
+ *            median latency until it is applied must be a frame later
+ *            than stepped inline, to within a quarter of a frame.
+ *   @return  The process exit code.
+ */
+int runLatencyCheck()
+{
+  bool improved = true;
+  bool frame_later = true;
+  for (const double frame_hz : { 60.0, 144.0 })
+  {
+    const auto stepped = playFrames(frame_hz, false, false);
+    const auto pipelined = playFrames(frame_hz, false, true);
+    const auto latched = playFrames(frame_hz, true, false);
+    printResult(frame_hz, "stepped", stepped);
+    printResult(frame_hz, "pipelined", pipelined);
+    printResult(frame_hz, "late latch", latched);
+    improved = improved && latched.displayed.count > 0 &&
+               latched.displayed.p50_ms < stepped.displayed.p50_ms;
+
+    const double period_ms = 1000.0 / frame_hz;
+    const double later_ms = pipelined.applied.p50_ms - stepped.applied.p50_ms;
+    frame_later = frame_later && pipelined.applied.count > 0 &&
+                  std::fabs(later_ms - period_ms) <= period_ms / 4;
+  }
+
+  std::printf("latency: late latch %s\n",
+              improved ? "lowers the median latency"
+                       : "DOES NOT lower the median latency");
+  std::printf("latency: pipelined input is applied %s\n",
+              frame_later ? "a frame later"
+                          : "NOT a frame later");
+  return improved && frame_later ? 0 : 1;
+}
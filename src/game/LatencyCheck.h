@@ -0,0 +1,10 @@
+#pragma once
+
+/**
+ *  Headless check of the input to display latency, run from the command
+ *  line. Synthetic paddle input is fed through the game's frame loop on
+ *  a mock clock, once with the paddle moved by the fixed steps and once
+ *  with it late latched, and the latency percentiles of both are
+ *  compared.
+ */
+int runLatencyCheck();
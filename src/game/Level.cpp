@@ -0,0 +1,143 @@
+#include "Level.h"
+
+#include <algorithm>
+#include <sstream>
+
+/**
+ *   @brief   The level used when no level file can be loaded.
+ *   @return  Five full rows of bricks and four gems.
+ */
+LevelData LevelData::defaultLevel()
+{
+  LevelData level;
+  level.rows = { std::string(20, 'G'),
+                 std::string(20, 'P'),
+                 std::string(20, 'Y'),
+                 std::string(20, 'S'),
+                 std::string(20, 'R') };
+
+  level.gems.resize(4);
+  level.gems[0] = GemPlacement{ 145, 30, 2, 1 };
+  level.gems[1] = GemPlacement{ 465, 128, 7, 4 };
+  level.gems[2] = GemPlacement{ 720, 64, 11, 2 };
+  level.gems[3] = GemPlacement{ 912, 0, 14, 0 };
+  return level;
+}
+
+/**
+ *   @brief   Parses the text of a level file.
+ *   @param   text The contents of the file.
+ *   @param   level Receives the parsed level on success.
+ *   @param   error Receives a description of the first problem found.
+ *   @return  True if the whole file was valid.
+ */
+bool parseLevel(const std::string& text, LevelData& level, std::string& error)
+{
+  LevelData parsed;
+  std::istringstream stream(text);
+  std::string line;
+  int line_number = 0;
+
+  while (std::getline(stream, line))
+  {
+    line_number++;
+    std::istringstream tokens(line);
+    std::string keyword;
+    if (!(tokens >> keyword) || keyword[0] == '#')
+    {
+      continue;
+    }
+
+    if (keyword == "bricks")
+    {
+      std::string cells;
+      tokens >> cells;
+      for (char cell : cells)
+      {
+        TextureId texture;
+        if (cell != '.' && !brickTexture(cell, texture))
+        {
+          error = "line " + std::to_string(line_number) +
+                  ": unknown brick '" + std::string(1, cell) + "'";
+          return false;
+        }
+      }
+      parsed.rows.push_back(cells);
+    }
+    else if (keyword == "gem")
+    {
+      GemPlacement gem;
+      if (!(tokens >> gem.x >> gem.y >> gem.column >> gem.row))
+      {
+        error = "line " + std::to_string(line_number) +
+                ": expected gem <x> <y> <column> <row>";
+        return false;
+      }
+      parsed.gems.push_back(gem);
+    }
+    else
+    {
+      error = "line " + std::to_string(line_number) + ": unknown keyword '" +
+              keyword + "'";
+      return false;
+    }
+  }
+
+  level = std::move(parsed);
+  return true;
+}
+
+/**
+ *   @brief   Maps a level file character to a brick texture.
+ *   @param   cell The character from a bricks line.
+ *   @param   texture Receives the texture for the brick.
+ *   @return  False if the character is not a brick.
+ */
+bool brickTexture(char cell, TextureId& texture)
+{
+  switch (cell)
+  {
+    case 'G':
+      texture = TextureId::BRICK_GREEN;
+      return true;
+    case 'P':
+      texture = TextureId::BRICK_PURPLE;
+      return true;
+    case 'Y':
+      texture = TextureId::BRICK_YELLOW;
+      return true;
+    case 'S':
+      texture = TextureId::BRICK_GREY;
+      return true;
+    case 'R':
+      texture = TextureId::BRICK_RED;
+      return true;
+    default:
+      return false;
+  }
+}
+
+/**
+ *   @brief   Finds the rows and gems that changed between two levels.
+ *   @details Rows that only exist in one of the levels count as changed.
+ *   @return  The changed row indices, in ascending order.
+ */
+LevelDiff diffLevels(const LevelData& before, const LevelData& after)
+{
+  LevelDiff diff;
+  const auto rows = std::max(before.rows.size(), after.rows.size());
+  for (std::size_t row = 0; row < rows; row++)
+  {
+    if (row >= before.rows.size() || row >= after.rows.size() ||
+        before.rows[row] != after.rows[row])
+    {
+      diff.rows.push_back(static_cast<int>(row));
+    }
+  }
+
+  diff.gems = before.gems.size() != after.gems.size() ||
+              !std::equal(before.gems.begin(),
+                          before.gems.end(),
+                          after.gems.begin());
+  return diff;
+}
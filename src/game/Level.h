@@ -0,0 +1,46 @@
+#pragma once
+#include <string>
+#include <vector>
+
+#include "Textures.h"
+
+/** A gem that falls once the brick at column, row is destroyed. */
+struct GemPlacement
+{
+  float x = 0;
+  float y = 0;
+  int column = 0;
+  int row = 0;
+
+  bool operator==(const GemPlacement& rhs) const
+  {
+    return x == rhs.x && y == rhs.y && column == rhs.column && row == rhs.row;
+  }
+};
+
+/**
+ *  The layout of a level.
+ *  Each brick row is a string with one character per column; see
+ *  data/levels/level1.txt for the file format. Rows are the unit of
+ *  hot reload, so an edit only respawns the rows it touched.
+ */
+struct LevelData
+{
+  std::vector<std::string> rows;
+  std::vector<GemPlacement> gems;
+
+  static LevelData defaultLevel();
+};
+
+/** The parts of a level that differ between two versions. */
+struct LevelDiff
+{
+  std::vector<int> rows;
+  bool gems = false;
+
+  bool empty() const { return rows.empty() && !gems; }
+};
+
+bool parseLevel(const std::string& text, LevelData& level, std::string& error);
+bool brickTexture(char cell, TextureId& texture);
+LevelDiff diffLevels(const LevelData& before, const LevelData& after);
@@ -0,0 +1,219 @@
+#include "Metrics.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <utility>
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free &&
+                std::atomic<double>::is_always_lock_free,
+              "metrics must be lock free to update from the game loop");
+
+namespace
+{
+  std::string formatNumber(double value)
+  {
+    if (std::isinf(value))
+    {
+      return value > 0 ? "+Inf" : "-Inf";
+    }
+
+    // the shortest text that reads back as the same value
+    char text[32];
+    const auto result = std::to_chars(text, text + sizeof(text), value);
+    return std::string(text, result.ptr);
+  }
+
+  void appendHeader(std::string& out,
+                    const std::string& name,
+                    const std::string& help,
+                    const char* type)
+  {
+    out += "# HELP " + name + " " + help + "\n";
+    out += "# TYPE " + name + " " + type + "\n";
+  }
+}
+
+void Counter::add(std::uint64_t amount)
+{
+  value.fetch_add(amount, std::memory_order_relaxed);
+}
+
+std::uint64_t Counter::get() const
+{
+  return value.load(std::memory_order_relaxed);
+}
+
+void Gauge::set(double amount)
+{
+  value.store(amount, std::memory_order_relaxed);
+}
+
+double Gauge::get() const
+{
+  return value.load(std::memory_order_relaxed);
+}
+
+/**
+ *   @brief   Constructor.
+ *   @param   upper_bounds The inclusive upper bound of each bucket. A
+ *            final +Inf bucket is always added.
+ */
+Histogram::Histogram(std::vector<double> upper_bounds) :
+  bounds(std::move(upper_bounds)),
+  buckets(std::make_unique<std::atomic<std::uint64_t>[]>(bounds.size() + 1))
+{
+  std::sort(bounds.begin(), bounds.end());
+}
+
+/**
+ *   @brief   Bounds that grow by a constant factor.
+ *   @param   start The first upper bound.
+ *   @param   factor Multiplies each bound to give the next.
+ *   @param   count The number of bounds.
+ *   @return  The upper bounds.
+ */
+std::vector<double>
+Histogram::exponentialBuckets(double start, double factor, int count)
+{
+  std::vector<double> result;
+  for (int i = 0; i < count; i++)
+  {
+    result.push_back(start);
+    start *= factor;
+  }
+  return result;
+}
+
+/**
+ *   @brief   Adds an observation to its bucket and to the sum.
+ *   @return  void
+ */
+void Histogram::observe(double amount)
+{
+  const auto bucket = static_cast<std::size_t>(
+    std::lower_bound(bounds.begin(), bounds.end(), amount) - bounds.begin());
+  buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+  sum.fetch_add(amount, std::memory_order_relaxed);
+}
+
+const std::vector<double>& Histogram::getBounds() const
+{
+  return bounds;
+}
+
+/**
+ *   @brief   The count in each bucket, not cumulative.
+ *   @return  One count per bound, then the +Inf bucket.
+ */
+std::vector<std::uint64_t> Histogram::getBucketCounts() const
+{
+  std::vector<std::uint64_t> counts(bounds.size() + 1);
+  for (std::size_t i = 0; i < counts.size(); i++)
+  {
+    counts[i] = buckets[i].load(std::memory_order_relaxed);
+  }
+  return counts;
+}
+
+double Histogram::getSum() const
+{
+  return sum.load(std::memory_order_relaxed);
+}
+
+/**
+ *   @brief   Registers a counter.
+ *   @param   name The metric name, ending in _total by convention.
+ *   @param   help A one line description.
+ *   @return  The counter, valid for the registry's lifetime.
+ */
+Counter& MetricsRegistry::counter(const std::string& name,
+                                  const std::string& help)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  Family family{ name, help, std::make_unique<Counter>(), nullptr, nullptr };
+  families.push_back(std::move(family));
+  return *families.back().counter;
+}
+
+/**
+ *   @brief   Registers a gauge.
+ *   @param   name The metric name.
+ *   @param   help A one line description.
+ *   @return  The gauge, valid for the registry's lifetime.
+ */
+Gauge& MetricsRegistry::gauge(const std::string& name,
+                              const std::string& help)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  Family family{ name, help, nullptr, std::make_unique<Gauge>(), nullptr };
+  families.push_back(std::move(family));
+  return *families.back().gauge;
+}
+
+/**
+ *   @brief   Registers a histogram.
+ *   @param   name The metric name, with its unit as a suffix.
+ *   @param   help A one line description.
+ *   @param   upper_bounds The bucket bounds.
+ *   @return  The histogram, valid for the registry's lifetime.
+ */
+Histogram& MetricsRegistry::histogram(const std::string& name,
+                                      const std::string& help,
+                                      std::vector<double> upper_bounds)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  Family family{ name,
+                 help,
+                 nullptr,
+                 nullptr,
+                 std::make_unique<Histogram>(std::move(upper_bounds)) };
+  families.push_back(std::move(family));
+  return *families.back().histogram;
+}
+
+/**
+ *   @brief   Renders every metric in the Prometheus text format.
+ *   @details Histogram buckets are made cumulative here. The count is
+ *            taken from the buckets, so it always matches the +Inf
+ *            bucket even while observations are being added.
+ *   @return  The exposition text.
+ */
+std::string MetricsRegistry::render() const
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  std::string out;
+  for (const auto& family : families)
+  {
+    if (family.counter)
+    {
+      appendHeader(out, family.name, family.help, "counter");
+      out += family.name + " " + std::to_string(family.counter->get()) + "\n";
+    }
+    else if (family.gauge)
+    {
+      appendHeader(out, family.name, family.help, "gauge");
+      out += family.name + " " + formatNumber(family.gauge->get()) + "\n";
+    }
+    else if (family.histogram)
+    {
+      appendHeader(out, family.name, family.help, "histogram");
+      const auto& bounds = family.histogram->getBounds();
+      const auto counts = family.histogram->getBucketCounts();
+
+      std::uint64_t cumulative = 0;
+      for (std::size_t i = 0; i < counts.size(); i++)
+      {
+        cumulative += counts[i];
+        const auto bound =
+          i < bounds.size() ? formatNumber(bounds[i]) : std::string("+Inf");
+        out += family.name + "_bucket{le=\"" + bound + "\"} " +
+               std::to_string(cumulative) + "\n";
+      }
+      out += family.name + "_sum " +
+             formatNumber(family.histogram->getSum()) + "\n";
+      out += family.name + "_count " + std::to_string(cumulative) + "\n";
+    }
+  }
+  return out;
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/** A total that only goes up, such as bricks destroyed. */
+class Counter
+{
+ public:
+  void add(std::uint64_t amount = 1);
+  std::uint64_t get() const;
+
+ private:
+  std::atomic<std::uint64_t> value{ 0 };
+};
+
+/** A value that can go up and down, such as lives left. */
+class Gauge
+{
+ public:
+  void set(double amount);
+  double get() const;
+
+ private:
+  std::atomic<double> value{ 0 };
+};
+
+/**
+ *  Counts observations, such as frame times, into fixed buckets.
+ *  Each bucket is counted on its own, so an observation is a few
+ *  relaxed atomic additions and never waits on a reader.
+ */
+class Histogram
+{
+ public:
+  explicit Histogram(std::vector<double> upper_bounds);
+
+  static std::vector<double> exponentialBuckets(double start,
+                                                double factor,
+                                                int count);
+
+  void observe(double amount);
+
+  const std::vector<double>& getBounds() const;
+  std::vector<std::uint64_t> getBucketCounts() const;
+  double getSum() const;
+
+ private:
+  std::vector<double> bounds;
+  std::unique_ptr<std::atomic<std::uint64_t>[]> buckets; /**< Plus +Inf. */
+  std::atomic<double> sum{ 0 };
+};
+
+/**
+ *  Owns the game's metrics and renders them in the Prometheus text
+ *  exposition format.
+ *  Metrics are registered once, up front, and live as long as the
+ *  registry, so the game loop keeps references to them and updates
+ *  them without touching the registry again. Only registering and
+ *  rendering take the registry's lock.
+ */
+class MetricsRegistry
+{
+ public:
+  Counter& counter(const std::string& name, const std::string& help);
+  Gauge& gauge(const std::string& name, const std::string& help);
+  Histogram& histogram(const std::string& name,
+                       const std::string& help,
+                       std::vector<double> upper_bounds);
+
+  std::string render() const;
+
+ private:
+  struct Family
+  {
+    std::string name;
+    std::string help;
+    std::unique_ptr<Counter> counter;
+    std::unique_ptr<Gauge> gauge;
+    std::unique_ptr<Histogram> histogram;
+  };
+
+  mutable std::mutex mutex;
+  std::vector<Family> families;
+};
@@ -0,0 +1,309 @@
+#include "MetricsExporter.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+
+#ifdef __linux__
+#  include <arpa/inet.h>
+#  include <netinet/in.h>
+#  include <poll.h>
+#  include <sys/eventfd.h>
+#  include <sys/socket.h>
+#  include <sys/time.h>
+#  include <unistd.h>
+#endif
+
+/**
+ *   @brief   Constructor.
+ *   @param   metrics The registry to publish. Must outlive the exporter.
+ */
+MetricsExporter::MetricsExporter(const MetricsRegistry& metrics) :
+  registry(metrics)
+{
+#ifdef __linux__
+  wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+#endif
+}
+
+/**
+ *   @brief   Destructor.
+ *   @details Stops the export thread and releases the descriptors.
+ */
+MetricsExporter::~MetricsExporter()
+{
+  stop();
+#ifdef __linux__
+  if (wake_fd >= 0)
+  {
+    close(wake_fd);
+  }
+#endif
+}
+
+bool MetricsExporter::canServe()
+{
+#ifdef __linux__
+  return true;
+#else
+  return false;
+#endif
+}
+
+/**
+ *   @brief   Starts the export thread.
+ *   @param   file_path Where to write the metrics, or empty for none.
+ *   @param   port The local port to serve the metrics on, or zero for
+ *            none.
+ *   @param   flush_seconds How often the file is rewritten.
+ *   @return  True if the thread was started.
+ */
+bool MetricsExporter::start(const std::string& file_path,
+                            int port,
+                            double flush_seconds)
+{
+  if (running || (file_path.empty() && port <= 0))
+  {
+    return false;
+  }
+  if (port > 0 && !listenOn(port))
+  {
+    return false;
+  }
+
+  path = file_path;
+  interval = flush_seconds > 0 ? flush_seconds : 5.0;
+  running = true;
+  thread = std::thread(&MetricsExporter::exportLoop, this);
+  return true;
+}
+
+/**
+ *   @brief   Stops the export thread and waits for it to finish.
+ *   @details The file is written one last time on the way out, so it
+ *            holds the final values.
+ *   @return  void
+ */
+void MetricsExporter::stop()
+{
+  if (!running)
+  {
+    return;
+  }
+
+  running = false;
+#ifdef __linux__
+  const std::uint64_t wake = 1;
+  if (write(wake_fd, &wake, sizeof(wake)) < 0)
+  {
+    // the poll timeout still ends the loop
+  }
+#endif
+  thread.join();
+
+#ifdef __linux__
+  if (listen_fd >= 0)
+  {
+    close(listen_fd);
+    listen_fd = -1;
+  }
+#endif
+}
+
+int MetricsExporter::getPort() const
+{
+  return bound_port;
+}
+
+MetricsExporter::Stats MetricsExporter::getStats() const
+{
+  Stats stats;
+  stats.flushes = flushes.load();
+  stats.scrapes = scrapes.load();
+  stats.failures = failures.load();
+  return stats;
+}
+
+/**
+ *   @brief   Opens the listening socket.
+ *   @details Binds to the loopback address only. Anything off the
+ *            cabinet reaches it through the cabinet's own agent.
+ *   @return  False if the port could not be bound.
+ */
+bool MetricsExporter::listenOn(int port)
+{
+#ifdef __linux__
+  if (wake_fd < 0 || port > 65535)
+  {
+    return false;
+  }
+
+  listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (listen_fd < 0)
+  {
+    return false;
+  }
+
+  const int reuse = 1;
+  setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(static_cast<std::uint16_t>(port));
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (bind(listen_fd,
+           reinterpret_cast<const sockaddr*>(&address),
+           sizeof(address)) < 0 ||
+      listen(listen_fd, 4) < 0)
+  {
+    close(listen_fd);
+    listen_fd = -1;
+    return false;
+  }
+
+  bound_port = port;
+  return true;
+#else
+  (void)port;
+  return false;
+#endif
+}
+
+void MetricsExporter::exportLoop()
+{
+  using Clock = std::chrono::steady_clock;
+  const auto period = std::chrono::duration_cast<Clock::duration>(
+    std::chrono::duration<double>(interval));
+  auto next_flush = Clock::now();
+
+  while (running)
+  {
+    if (!path.empty() && Clock::now() >= next_flush)
+    {
+      flushFile();
+      next_flush = std::max(next_flush + period, Clock::now());
+    }
+
+    // sleep until the next flush, a scrape or stop()
+    const auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(
+      next_flush - Clock::now());
+    const int timeout_ms = path.empty()
+                             ? 500
+                             : static_cast<int>(std::clamp<long long>(
+                                 wait.count(), 0, 500));
+#ifdef __linux__
+    pollfd fds[2] = { { wake_fd, POLLIN, 0 }, { listen_fd, POLLIN, 0 } };
+    if (poll(fds, listen_fd >= 0 ? 2 : 1, timeout_ms) <= 0 ||
+        !(fds[1].revents & POLLIN))
+    {
+      continue;
+    }
+
+    int client = -1;
+    while ((client = accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC)) >= 0)
+    {
+      serveClient(client);
+      close(client);
+    }
+#else
+    std::this_thread::sleep_for(std::chrono::milliseconds(timeout_ms));
+#endif
+  }
+
+  if (!path.empty())
+  {
+    flushFile();
+  }
+}
+
+/**
+ *   @brief   Writes the metrics to the file.
+ *   @details Writes a temporary file and renames it over the old one,
+ *            so a collector never reads a half written file.
+ *   @return  void
+ */
+void MetricsExporter::flushFile()
+{
+  const auto temporary = path + ".tmp";
+  {
+    std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+    file << registry.render();
+    if (!file)
+    {
+      failures++;
+      return;
+    }
+  }
+
+  if (std::rename(temporary.c_str(), path.c_str()) != 0)
+  {
+    failures++;
+    return;
+  }
+  flushes++;
+}
+
+/**
+ *   @brief   Answers one HTTP request with the metrics.
+ *   @details Any GET is answered, whatever its path. A client that
+ *            stalls is dropped after a second, so it cannot hold up the
+ *            file flushes for long.
+ *   @return  void
+ */
+void MetricsExporter::serveClient(int client)
+{
+#ifdef __linux__
+  timeval timeout{};
+  timeout.tv_sec = 1;
+  setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+  std::string request;
+  char buffer[1024];
+  while (request.find("\r\n\r\n") == std::string::npos &&
+         request.size() < 8192)
+  {
+    const auto length = recv(client, buffer, sizeof(buffer), 0);
+    if (length <= 0)
+    {
+      break;
+    }
+    request.append(buffer, static_cast<std::size_t>(length));
+  }
+
+  std::string body;
+  std::string response;
+  if (request.compare(0, 4, "GET ") == 0)
+  {
+    body = registry.render();
+    response = "HTTP/1.1 200 OK\r\n"
+               "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n";
+    scrapes++;
+  }
+  else
+  {
+    body = "bad request\n";
+    response = "HTTP/1.1 400 Bad Request\r\n"
+               "Content-Type: text/plain; charset=utf-8\r\n";
+    failures++;
+  }
+  response += "Content-Length: " + std::to_string(body.size()) +
+              "\r\nConnection: close\r\n\r\n" + body;
+
+  std::size_t sent = 0;
+  while (sent < response.size())
+  {
+    const auto length = send(
+      client, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+    if (length <= 0)
+    {
+      failures++;
+      return;
+    }
+    sent += static_cast<std::size_t>(length);
+  }
+#else
+  (void)client;
+#endif
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+#include "Metrics.h"
+
+/**
+ *  Publishes a metrics registry from its own thread, so rendering the
+ *  text never costs the game loop any time.
+ *  The metrics can be written to a file every few seconds, for a
+ *  textfile collector to pick up, and served over HTTP on a local port
+ *  for Prometheus to scrape. Serving needs Linux; on other platforms
+ *  canServe() returns false and only the file is written.
+ */
+class MetricsExporter
+{
+ public:
+  struct Stats
+  {
+    std::uint64_t flushes = 0;
+    std::uint64_t scrapes = 0;
+    std::uint64_t failures = 0; /**< Failed writes and bad requests. */
+  };
+
+  explicit MetricsExporter(const MetricsRegistry& metrics);
+  ~MetricsExporter();
+
+  MetricsExporter(const MetricsExporter&) = delete;
+  MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+  static bool canServe();
+  bool start(const std::string& file_path,
+             int port,
+             double flush_seconds = 5.0);
+  void stop();
+
+  int getPort() const;
+  Stats getStats() const;
+
+ private:
+  bool listenOn(int port);
+  void exportLoop();
+  void flushFile();
+  void serveClient(int client);
+
+  const MetricsRegistry& registry;
+  std::string path;
+  double interval = 5.0;
+
+  std::thread thread;
+  std::atomic<bool> running{ false };
+  int listen_fd = -1;
+  int wake_fd = -1;
+  int bound_port = 0;
+
+  std::atomic<std::uint64_t> flushes{ 0 };
+  std::atomic<std::uint64_t> scrapes{ 0 };
+  std::atomic<std::uint64_t> failures{ 0 };
+};
@@ -0,0 +1,90 @@
+#include "Physics.h"
+
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
+namespace
+{
+  bool overlapsRaw(const Fixed* box, const Fixed* pos, const Fixed* size)
+  {
+    return (pos[0] < box[0] + box[2]) && (pos[0] + size[0] > box[0]) &&
+           (pos[1] < box[1] + box[3]) && (pos[1] + size[1] > box[1]);
+  }
+
+#ifdef __SSE2__
+  /**
+   *   @brief   Splits four interleaved pairs into two lanes.
+   *   @details a0 b0 a1 b1 | a2 b2 a3 b3 becomes a0..a3 and b0..b3.
+   */
+  void deinterleave(const Fixed* pairs, __m128i& first, __m128i& second)
+  {
+    const __m128i low =
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(pairs));
+    const __m128i high =
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(pairs + 4));
+    const __m128i low_sorted = _mm_shuffle_epi32(low, _MM_SHUFFLE(3, 1, 2, 0));
+    const __m128i high_sorted =
+      _mm_shuffle_epi32(high, _MM_SHUFFLE(3, 1, 2, 0));
+    first = _mm_unpacklo_epi64(low_sorted, high_sorted);
+    second = _mm_unpackhi_epi64(low_sorted, high_sorted);
+  }
+#endif
+}
+
+/**
+ *   @brief   Fixed point overlapBatch() on interleaved raw pairs.
+ *   @details box holds x, y, w, h. Each compare is done on the raw
+ *            integers, so the result matches overlaps() exactly.
+ *   @return  The number of overlapping boxes.
+ */
+std::size_t overlapBatchFixed(const Fixed* box,
+                              const Fixed* positions,
+                              const Fixed* sizes,
+                              std::size_t count,
+                              std::uint8_t* hits)
+{
+  std::size_t total = 0;
+  std::size_t i = 0;
+
+#ifdef __SSE2__
+  const __m128i left = _mm_set1_epi32(box[0].raw());
+  const __m128i top = _mm_set1_epi32(box[1].raw());
+  const __m128i right = _mm_set1_epi32((box[0] + box[2]).raw());
+  const __m128i bottom = _mm_set1_epi32((box[1] + box[3]).raw());
+
+  for (; i + 4 <= count; i += 4)
+  {
+    __m128i xs;
+    __m128i ys;
+    __m128i ws;
+    __m128i hs;
+    deinterleave(positions + i * 2, xs, ys);
+    deinterleave(sizes + i * 2, ws, hs);
+
+    const __m128i x_hit =
+      _mm_and_si128(_mm_cmplt_epi32(xs, right),
+                    _mm_cmpgt_epi32(_mm_add_epi32(xs, ws), left));
+    const __m128i y_hit =
+      _mm_and_si128(_mm_cmplt_epi32(ys, bottom),
+                    _mm_cmpgt_epi32(_mm_add_epi32(ys, hs), top));
+    const int mask =
+      _mm_movemask_ps(_mm_castsi128_ps(_mm_and_si128(x_hit, y_hit)));
+
+    for (int lane = 0; lane < 4; lane++)
+    {
+      hits[i + static_cast<std::size_t>(lane)] =
+        static_cast<std::uint8_t>((mask >> lane) & 1);
+    }
+    total += static_cast<std::size_t>(__builtin_popcount(
+      static_cast<unsigned int>(mask)));
+  }
+#endif
+
+  for (; i < count; i++)
+  {
+    hits[i] = overlapsRaw(box, positions + i * 2, sizes + i * 2) ? 1 : 0;
+    total += hits[i];
+  }
+  return total;
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include "Fixed.h"
+
+/**
+ *  The number type used for positions, sizes and velocities.
+ *  Define BREAKOUT_FIXED_POINT (the CMake option of the same name) to
+ *  simulate in Q16.16 fixed point, which gives bit-exact results across
+ *  compilers and CPUs for replays and lockstep.
+ */
+#ifdef BREAKOUT_FIXED_POINT
+using Scalar = Fixed;
+
+inline Scalar toScalar(float value)
+{
+  return Fixed::fromFloat(value);
+}
+inline float toFloat(Scalar value)
+{
+  return value.toFloat();
+}
+#else
+using Scalar = float;
+
+inline Scalar toScalar(float value)
+{
+  return value;
+}
+inline float toFloat(Scalar value)
+{
+  return value;
+}
+#endif
+
+/**
+ *   @brief   Axis aligned bounding box test.
+ *   @details Works with any position and size types holding x, y and
+ *            w, h members, so it serves both number types.
+ *   @return  True if the two boxes overlap.
+ */
+template<typename P, typename S>
+inline bool
+overlaps(const P& pos_a, const S& size_a, const P& pos_b, const S& size_b)
+{
+  return (pos_b.x < pos_a.x + size_a.w) && (pos_b.x + size_b.w > pos_a.x) &&
+         (pos_b.y < pos_a.y + size_a.h) && (pos_b.y + size_b.h > pos_a.y);
+}
+
+/**
+ *   @brief   Tests one box against an array of boxes.
+ *   @param   hits Receives 1 for each overlapping box and 0 otherwise.
+ *   @return  The number of overlapping boxes.
+ */
+template<typename P, typename S>
+inline std::size_t overlapBatch(const P& pos,
+                                const S& size,
+                                const P* others,
+                                const S* other_sizes,
+                                std::size_t count,
+                                std::uint8_t* hits)
+{
+  std::size_t total = 0;
+  for (std::size_t i = 0; i < count; i++)
+  {
+    hits[i] = overlaps(pos, size, others[i], other_sizes[i]) ? 1 : 0;
+    total += hits[i];
+  }
+  return total;
+}
+
+/**
+ *   @brief   Fixed point overlapBatch() on interleaved raw pairs.
+ *   @details Uses SSE2 integer compares four boxes at a time where
+ *            available. positions and sizes hold x,y and w,h pairs.
+ *   @return  The number of overlapping boxes.
+ */
+std::size_t overlapBatchFixed(const Fixed* box,
+                              const Fixed* positions,
+                              const Fixed* sizes,
+                              std::size_t count,
+                              std::uint8_t* hits);
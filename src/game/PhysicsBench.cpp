@@ -0,0 +1,329 @@
+#include "PhysicsBench.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "Simulation.h"
+
+namespace
+{
+#ifdef BREAKOUT_FIXED_POINT
+  /** The state hash of a fixed point build after the default steps. */
+  const std::uint64_t expected_fixed_hash = 0x8e54558e27a5045bULL;
+#endif
+
+  struct FloatPos
+  {
+    float x;
+    float y;
+  };
+
+  struct FloatSize
+  {
+    float w;
+    float h;
+  };
+
+  struct FixedPos
+  {
+    Fixed x;
+    Fixed y;
+  };
+
+  struct FixedSize
+  {
+    Fixed w;
+    Fixed h;
+  };
+
+  void hashBytes(std::uint64_t& value, const void* data, std::size_t size)
+  {
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    for (std::size_t i = 0; i < size; i++)
+    {
+      value ^= bytes[i];
+      value *= 1099511628211ULL;
+    }
+  }
+
+  void hashScalar(std::uint64_t& value, Scalar scalar)
+  {
+#ifdef BREAKOUT_FIXED_POINT
+    const std::int32_t bits = scalar.raw();
+#else
+    std::uint32_t bits = 0;
+    std::memcpy(&bits, &scalar, sizeof(bits));
+#endif
+    hashBytes(value, &bits, sizeof(bits));
+  }
+
+  void hashInt(std::uint64_t& value, int number)
+  {
+    hashBytes(value, &number, sizeof(number));
+  }
+
+  /**
+   *   @brief   Plays the game with a simple scripted player.
+   *   @details Follows the ball, aiming slightly off centre in a
+   *            repeating pattern so the ball reaches the whole level.
+   *   @return  void
+   */
+  void drivePlayer(Simulation& simulation, int step)
+  {
+    auto& world = simulation.getWorld();
+
+    Scalar ball_centre = Scalar(0);
+    bool served = true;
+    world.each<Position, Size, Ball>(
+      [&](Entity, const Position& pos, const Size& size, const Ball& data) {
+        ball_centre = pos.x + size.w / Scalar(2);
+        served = data.served;
+      });
+
+    Scalar paddle_centre = Scalar(0);
+    world.each<Position, Size, Paddle>(
+      [&](Entity, const Position& pos, const Size& size, const Paddle&) {
+        paddle_centre = pos.x + size.w / Scalar(2);
+      });
+
+    const Scalar aim =
+      paddle_centre + Scalar((step / 240) % 5 - 2) * Scalar(12);
+    const Scalar dead_zone = Scalar(8);
+    if (ball_centre < aim - dead_zone)
+    {
+      simulation.setPaddleDirection(-1);
+    }
+    else if (ball_centre > aim + dead_zone)
+    {
+      simulation.setPaddleDirection(1);
+    }
+    else
+    {
+      simulation.setPaddleDirection(0);
+    }
+
+    if (!served)
+    {
+      simulation.serve();
+    }
+  }
+
+  template<typename Fn>
+  double timeMs(Fn&& fn)
+  {
+    const auto start = std::chrono::steady_clock::now();
+    fn();
+    const std::chrono::duration<double, std::milli> elapsed =
+      std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+  }
+
+  /** Small deterministic generator, so every run tests the same boxes. */
+  struct Lcg
+  {
+    std::uint32_t state = 12345;
+
+    int next(int range)
+    {
+      state = state * 1664525U + 1013904223U;
+      return static_cast<int>((state >> 8) % static_cast<std::uint32_t>(range));
+    }
+  };
+}
+
+/**
+ *   @brief   Replays a scripted game and hashes the result.
+ *   @details Hashes the raw bits of every position and velocity along
+ *            with the score, lives and the number of steps run. The
+ *            game stops early once it is won or lost.
+ *   @param   steps The number of fixed steps to run.
+ *   @return  A 64 bit FNV-1a hash of the final state.
+ */
+std::uint64_t determinismHash(int steps)
+{
+  Simulation simulation;
+  simulation.reset(1280, 720);
+
+  int step = 0;
+  for (; step < steps && !simulation.isWon() && !simulation.isLost(); step++)
+  {
+    drivePlayer(simulation, step);
+    simulation.step();
+  }
+
+  std::uint64_t value = 14695981039346656037ULL;
+  auto& world = simulation.getWorld();
+  world.each<Position>([&value](Entity, const Position& pos) {
+    hashScalar(value, pos.x);
+    hashScalar(value, pos.y);
+  });
+  world.each<Velocity>([&value](Entity, const Velocity& vel) {
+    hashScalar(value, vel.x);
+    hashScalar(value, vel.y);
+  });
+  hashInt(value, simulation.getScore());
+  hashInt(value, simulation.getLives());
+  hashInt(value, step);
+  return value;
+}
+
+/**
+ *   @brief   Prints the state hash and checks it against the reference.
+ *   @details Fixed point builds must reproduce the reference hash
+ *            exactly, whatever the compiler or optimisation level.
+ *            Floating point builds have no reference and only print.
+ *   @param   steps The number of fixed steps to run.
+ *   @return  The process exit code.
+ */
+int runDeterminismCheck(int steps)
+{
+  const auto value = determinismHash(steps);
+  std::printf("determinism: %d steps, state hash %016llx\n",
+              steps,
+              static_cast<unsigned long long>(value));
+
+#ifdef BREAKOUT_FIXED_POINT
+  if (steps == determinism_default_steps)
+  {
+    const bool matched = value == expected_fixed_hash;
+    std::printf("determinism: %s reference %016llx\n",
+                matched ? "matches" : "DIFFERS from",
+                static_cast<unsigned long long>(expected_fixed_hash));
+    return matched ? 0 : 1;
+  }
+#else
+  std::printf("determinism: floating point build, no reference hash\n");
+#endif
+  return 0;
+}
+
+/**
+ *   @brief   Benchmarks the collision paths and the full simulation.
+ *   @details Tests a stream of ball positions against a field of brick
+ *            sized boxes with floats, with fixed point and with the
+ *            SIMD fixed point kernel. Coordinates are quarter units, so
+ *            all three must agree on every hit. Then times complete
+ *            steps of the simulation in the number type of this build.
+ *   @return  The process exit code.
+ */
+int runPhysicsBenchmark()
+{
+  enum
+  {
+    boxes = 4096,
+    queries = 4096
+  };
+
+  Lcg random;
+  std::vector<FloatPos> float_pos(boxes);
+  std::vector<FloatSize> float_size(boxes);
+  std::vector<FixedPos> fixed_pos(boxes);
+  std::vector<FixedSize> fixed_size(boxes);
+  for (std::size_t i = 0; i < boxes; i++)
+  {
+    float_pos[i] = FloatPos{ static_cast<float>(random.next(1280 * 4)) / 4,
+                             static_cast<float>(random.next(720 * 4)) / 4 };
+    float_size[i] = FloatSize{ 64, 32 };
+    fixed_pos[i] = FixedPos{ Fixed::fromFloat(float_pos[i].x),
+                             Fixed::fromFloat(float_pos[i].y) };
+    fixed_size[i] = FixedSize{ Fixed(64), Fixed(32) };
+  }
+
+  std::vector<FloatPos> probes(queries);
+  for (auto& probe : probes)
+  {
+    probe = FloatPos{ static_cast<float>(random.next(1280 * 4)) / 4,
+                      static_cast<float>(random.next(720 * 4)) / 4 };
+  }
+  const FloatSize ball_size{ 22, 22 };
+  std::vector<std::uint8_t> hits(boxes);
+
+  std::size_t float_hits = 0;
+  const double float_ms = timeMs([&] {
+    for (const auto& probe : probes)
+    {
+      float_hits += overlapBatch(probe,
+                                 ball_size,
+                                 float_pos.data(),
+                                 float_size.data(),
+                                 boxes,
+                                 hits.data());
+    }
+  });
+
+  std::size_t fixed_hits = 0;
+  const double fixed_ms = timeMs([&] {
+    for (const auto& probe : probes)
+    {
+      const FixedPos pos{ Fixed::fromFloat(probe.x),
+                          Fixed::fromFloat(probe.y) };
+      const FixedSize size{ Fixed(22), Fixed(22) };
+      fixed_hits += overlapBatch(
+        pos, size, fixed_pos.data(), fixed_size.data(), boxes, hits.data());
+    }
+  });
+
+  std::size_t simd_hits = 0;
+  const double simd_ms = timeMs([&] {
+    for (const auto& probe : probes)
+    {
+      const Fixed box[] = { Fixed::fromFloat(probe.x),
+                            Fixed::fromFloat(probe.y),
+                            Fixed(22),
+                            Fixed(22) };
+      simd_hits += overlapBatchFixed(box,
+                                     &fixed_pos.data()->x,
+                                     &fixed_size.data()->w,
+                                     boxes,
+                                     hits.data());
+    }
+  });
+
+  const double tests =
+    static_cast<double>(boxes) * static_cast<double>(queries);
+  std::printf("overlap  float scalar  %8.3f ms %6.3f ns/test %zu hits\n",
+              float_ms,
+              float_ms * 1e6 / tests,
+              float_hits);
+  std::printf("overlap  fixed scalar  %8.3f ms %6.3f ns/test %zu hits\n",
+              fixed_ms,
+              fixed_ms * 1e6 / tests,
+              fixed_hits);
+  std::printf("overlap  fixed simd    %8.3f ms %6.3f ns/test %zu hits\n",
+              simd_ms,
+              simd_ms * 1e6 / tests,
+              simd_hits);
+
+  Simulation simulation;
+  simulation.reset(1280, 720);
+  int steps = 0;
+  const double sim_ms = timeMs([&] {
+    for (; steps < determinism_default_steps && !simulation.isWon() &&
+           !simulation.isLost();
+         steps++)
+    {
+      drivePlayer(simulation, steps);
+      simulation.step();
+    }
+  });
+
+#ifdef BREAKOUT_FIXED_POINT
+  const char* path = "fixed point";
+#else
+  const char* path = "floating point";
+#endif
+  std::printf("simulation %s: %d steps in %.3f ms, %.0f steps/s\n",
+              path,
+              steps,
+              sim_ms,
+              sim_ms > 0 ? steps * 1000.0 / sim_ms : 0.0);
+
+  const bool agreed = float_hits == fixed_hits && fixed_hits == simd_hits;
+  if (!agreed)
+  {
+    std::printf("overlap results differ between paths\n");
+  }
+  return agreed ? 0 : 1;
+}
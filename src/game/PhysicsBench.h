@@ -0,0 +1,18 @@
+#pragma once
+#include <cstdint>
+
+/**
+ *  Headless checks of the physics, run from the command line.
+ *  The determinism check replays a scripted game and hashes the full
+ *  simulation state, so builds from different compilers, flags or CPUs
+ *  can be compared. The benchmark compares the floating point and fixed
+ *  point collision paths.
+ */
+enum
+{
+  determinism_default_steps = 20000
+};
+
+std::uint64_t determinismHash(int steps);
+int runDeterminismCheck(int steps);
+int runPhysicsBenchmark();
@@ -0,0 +1,168 @@
+#include "PipelineBench.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "FramePipeline.h"
+#include "Simulation.h"
+#include "Viewport.h"
+
+namespace
+{
+  enum
+  {
+    frames = 1200,
+    arena_columns = 500,
+    arena_rows = 200
+  };
+
+  const double frame_seconds = 1.0 / 60.0;
+
+  struct Result
+  {
+    double total_ms = 0;
+    double wait_ms = 0;
+    double work_ms = 0;
+    std::uint64_t drawn = 0; /**< Hash of every draw list built. */
+  };
+
+  /**
+   *   @brief   Follows the ball, deciding from the latest snapshot.
+   *   @return  void
+   */
+  void drivePlayer(Simulation& simulation, const FrameSnapshot& snapshot)
+  {
+    bool served = true;
+    for (const auto& item : snapshot.items)
+    {
+      if (item.texture != TextureId::BALL)
+      {
+        continue;
+      }
+
+      served = !item.latched;
+      const float ball_centre = item.x + item.w / 2;
+      const float paddle_centre =
+        snapshot.paddle.x + textureInfo(TextureId::PADDLE).width / 2;
+      simulation.setPaddleDirection(ball_centre < paddle_centre - 8 ? -1
+                                    : ball_centre > paddle_centre + 8 ? 1
+                                                                      : 0);
+    }
+
+    if (!served)
+    {
+      simulation.serve();
+    }
+  }
+
+  /**
+   *   @brief   Builds a draw list as render() does and hashes it.
+   *   @return  void
+   */
+  void buildDrawList(const FrameSnapshot& snapshot,
+                     const Viewport& viewport,
+                     std::vector<Viewport::Rect>& draw_list,
+                     std::uint64_t& hash)
+  {
+    if (snapshot.sequence == 0)
+    {
+      return;
+    }
+
+    draw_list.clear();
+    for (const auto& item : snapshot.items)
+    {
+      draw_list.push_back(viewport.toWindow(item.x, item.y, item.w, item.h));
+    }
+
+    for (const auto& rect : draw_list)
+    {
+      for (const float value : { rect.x, rect.y, rect.w, rect.h })
+      {
+        hash ^= static_cast<std::uint64_t>(value * 64.0F);
+        hash *= 1099511628211ULL;
+      }
+    }
+  }
+
+  Result playFrames(bool pipelined)
+  {
+    Simulation simulation;
+    simulation.setArena(arena_columns, arena_rows);
+    simulation.reset(1280, 720);
+
+    FramePipeline pipeline([&simulation](FrameSnapshot& snapshot) {
+      snapshot.steps = simulation.advance(frame_seconds);
+      simulation.capture(snapshot);
+    });
+    pipeline.setPipelined(pipelined);
+
+    Viewport viewport(1280, 720);
+    viewport.setWindowSize(1920, 1080);
+    std::vector<Viewport::Rect> draw_list;
+
+    Result result;
+    result.drawn = 14695981039346656037ULL;
+    const auto start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < frames; frame++)
+    {
+      const auto wait_start = std::chrono::steady_clock::now();
+      pipeline.finish();
+      const std::chrono::duration<double, std::milli> wait =
+        std::chrono::steady_clock::now() - wait_start;
+      result.wait_ms += wait.count();
+
+      drivePlayer(simulation, pipeline.front());
+      pipeline.start();
+      buildDrawList(pipeline.front(), viewport, draw_list, result.drawn);
+    }
+
+    // pipelined, the last frame's snapshot has not been drawn yet
+    pipeline.finish();
+    if (pipelined)
+    {
+      buildDrawList(pipeline.front(), viewport, draw_list, result.drawn);
+    }
+
+    const std::chrono::duration<double, std::milli> total =
+      std::chrono::steady_clock::now() - start;
+    result.total_ms = total.count();
+    result.work_ms = pipeline.getStats().work_ms;
+    return result;
+  }
+
+  void printResult(const char* mode, const Result& result)
+  {
+    const auto count = static_cast<double>(frames);
+    std::printf("pipeline %-3s %d frames %8.1f frames/s  main busy %5.1f%%  "
+                "wait %7.3f ms/frame  sim %7.3f ms\n",
+                mode,
+                static_cast<int>(frames),
+                count * 1000.0 / result.total_ms,
+                100.0 * (result.total_ms - result.wait_ms) / result.total_ms,
+                result.wait_ms / count,
+                result.work_ms);
+  }
+}
+
+/**
+ *   @brief   Compares frame throughput with and without pipelining.
+ *   @details Frames are not throttled, so the frame rate is the most
+ *            the machine can manage. Both modes must draw exactly the
+ *            same sequence of frames.
+ *   @return  The process exit code.
+ */
+int runPipelineBenchmark()
+{
+  const auto serial = playFrames(false);
+  const auto pipelined = playFrames(true);
+  printResult("off", serial);
+  printResult("on", pipelined);
+
+  const bool matched = serial.drawn == pipelined.drawn;
+  std::printf("pipeline: draw lists %s\n",
+              matched ? "match" : "DIFFER between modes");
+  return matched ? 0 : 1;
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+/**
+ *  Headless benchmark of the frame pipeline, run from the command line.
+ *  Plays an arena game with a scripted player and builds draw lists
+ *  from the snapshots as render() does, with and without pipelining,
+ *  and reports the frame rate and how busy the main thread was.
+ */
+int runPipelineBenchmark();
@@ -0,0 +1,311 @@
+#include "PredictorCheck.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+
+#include "BallPredictor.h"
+#include "Simulation.h"
+
+namespace
+{
+  enum
+  {
+    checked_steps = 30000,
+    timed_frames = 600,
+    queries_per_frame = 4000,
+    arena_columns = 500,
+    arena_rows = 200
+  };
+
+  const double query_budget_us = 1.0;
+  const float paddle_dead_zone = 4;
+
+  /** How far the ball may be from a predicted point, in game units. */
+  const double position_tolerance = 0.01;
+
+  /** Small deterministic generator, so every run plays the same game. */
+  struct Lcg
+  {
+    std::uint32_t state = 777;
+
+    int next(int range)
+    {
+      state = state * 1664525U + 1013904223U;
+      return static_cast<int>((state >> 8) % static_cast<std::uint32_t>(range));
+    }
+  };
+
+  struct Result
+  {
+    std::uint64_t paths = 0;
+    std::uint64_t contacts = 0;
+    std::uint64_t mismatches = 0;
+    std::uint64_t traces = 0;
+    double average_trace_us = 0;
+    double query_us = 0;
+    double worst_frame_us = 0; /**< All of a frame's queries. */
+  };
+
+  bool isXContact(const BallContact& contact)
+  {
+    return contact.kind == BallContact::Kind::LEFT_WALL ||
+           contact.kind == BallContact::Kind::RIGHT_WALL;
+  }
+
+  /**
+   *   @brief   Plays the game with a player guided by the predictor.
+   *   @details Before each serve the paddle moves to a random spot, so
+   *            paths start all over the field. Once served it moves to
+   *            the predicted landing point.
+   *   @return  void
+   */
+  void drivePlayer(Simulation& simulation,
+                   const BallPrediction& prediction,
+                   Lcg& random,
+                   int& serve_target)
+  {
+    const auto ball = simulation.getBallState();
+    const auto paddle = simulation.getPaddleState();
+    const float paddle_centre =
+      paddle.x + textureInfo(TextureId::PADDLE).width / 2;
+
+    float target = prediction.landing_x;
+    if (!ball.served)
+    {
+      if (serve_target < 0)
+      {
+        serve_target = random.next(static_cast<int>(toFloat(ball.area_width)));
+      }
+      target = static_cast<float>(serve_target);
+      if (std::fabs(paddle_centre - target) <= paddle_dead_zone ||
+          (paddle.x <= 0 && target < paddle_centre) ||
+          (paddle.x >= paddle.max_x && target > paddle_centre))
+      {
+        simulation.serve();
+        serve_target = -1;
+      }
+    }
+
+    const int direction = target < paddle_centre - paddle_dead_zone   ? -1
+                          : target > paddle_centre + paddle_dead_zone ? 1
+                                                                      : 0;
+    simulation.setPaddleDirection(direction);
+  }
+
+  /**
+   *   @brief   Checks predicted paths against the stepped game.
+   *   @details A path is traced, uncached, each time the ball leaves
+   *            the paddle. Every step until it lands, the ball must turn
+   *            exactly where the path says, be where the path says at
+   *            each contact, and have destroyed each brick the path
+   *            hits. The cached predictor used by the player must agree
+   *            on the landing after every bounce along the way.
+   *   @return  The counts of paths, contacts and mismatches.
+   */
+  Result checkPaths(int columns, int rows)
+  {
+    Simulation simulation;
+    simulation.setArena(columns, rows);
+    simulation.reset(1280, 720);
+
+    BallPredictor predictor;
+    BallPredictor reference;
+    BallPrediction path;
+    bool following = false;
+    std::size_t next_contact = 0;
+
+    Lcg random;
+    int serve_target = -1;
+    Result result;
+
+    const auto mismatch = [&](const char* what, std::uint64_t step) {
+      if (result.mismatches == 0)
+      {
+        std::printf("predictor: %s at step %llu\n",
+                    what,
+                    static_cast<unsigned long long>(step));
+      }
+      result.mismatches++;
+      following = false;
+    };
+
+    for (int i = 0; i < checked_steps; i++)
+    {
+      const auto& prediction = predictor.predict(simulation);
+      if (following && prediction.lands &&
+          (prediction.landing_step != path.landing_step ||
+           prediction.landing_x != path.landing_x))
+      {
+        mismatch("cached landing differs", simulation.getStepCount());
+      }
+      drivePlayer(simulation, prediction, random, serve_target);
+
+      const auto before = simulation.getBallState();
+      if (!following && before.served &&
+          before.velocity.y < Scalar(0))
+      {
+        reference.trace(simulation, before, path);
+        following = path.lands;
+        next_contact = 0;
+        result.paths++;
+      }
+
+      simulation.step();
+      if (simulation.isLost() || simulation.isWon())
+      {
+        simulation.restart();
+        following = false;
+        continue;
+      }
+      if (!following)
+      {
+        continue;
+      }
+
+      const auto after = simulation.getBallState();
+      if (!after.served)
+      {
+        mismatch("ball lost before landing", after.step);
+        continue;
+      }
+      if (after.step == path.landing_step)
+      {
+        const double centre = toFloat(after.pos.x + after.size.w / Scalar(2));
+        if (next_contact != path.contacts.size() ||
+            std::fabs(centre - path.landing_x) > position_tolerance ||
+            after.pos.y + after.size.h <= after.paddle_y ||
+            before.pos.y + before.size.h > before.paddle_y)
+        {
+          mismatch("landing differs", after.step);
+        }
+        following = false;
+        continue;
+      }
+
+      // the path's contacts this step, and the turns they make
+      bool turn_x = false;
+      bool turn_y = false;
+      for (; next_contact < path.contacts.size() &&
+             path.contacts[next_contact].step == after.step;
+           next_contact++)
+      {
+        const auto& contact = path.contacts[next_contact];
+        result.contacts++;
+        turn_x = turn_x != isXContact(contact);
+        turn_y = turn_y != !isXContact(contact);
+        if (std::fabs(contact.x - toFloat(after.pos.x)) > position_tolerance ||
+            std::fabs(contact.y - toFloat(after.pos.y)) > position_tolerance ||
+            (contact.kind == BallContact::Kind::BRICK &&
+             simulation.hasBrick(contact.column, contact.row)))
+        {
+          mismatch("contact differs", after.step);
+        }
+      }
+      const Scalar zero(0);
+      if (turn_x != ((after.velocity.x > zero) != (before.velocity.x > zero)) ||
+          turn_y != ((after.velocity.y > zero) != (before.velocity.y > zero)))
+      {
+        mismatch("ball turned off the path", after.step);
+      }
+    }
+
+    const auto stats = predictor.getStats();
+    result.traces = stats.traces;
+    result.average_trace_us = stats.average_trace_us;
+    return result;
+  }
+
+  /**
+   *   @brief   Times queries as an overlay and bots would make them.
+   *   @details Plays at 60 frames a second, and every frame makes
+   *            queries_per_frame queries, which all but the first answer
+   *            from the cache.
+   *   @return  void
+   */
+  void timeQueries(int columns, int rows, Result& result)
+  {
+    Simulation simulation;
+    simulation.setArena(columns, rows);
+    simulation.reset(1280, 720);
+
+    BallPredictor predictor;
+    Lcg random;
+    int serve_target = -1;
+    double total_us = 0;
+    float landing = 0;
+
+    for (int frame = 0; frame < timed_frames; frame++)
+    {
+      simulation.advance(1.0 / 60.0);
+      if (simulation.isLost() || simulation.isWon())
+      {
+        simulation.restart();
+      }
+
+      const auto start = std::chrono::steady_clock::now();
+      for (int query = 0; query < queries_per_frame; query++)
+      {
+        landing += predictor.predict(simulation).landing_x;
+      }
+      const std::chrono::duration<double, std::micro> elapsed =
+        std::chrono::steady_clock::now() - start;
+      total_us += elapsed.count();
+      result.worst_frame_us = std::max(result.worst_frame_us, elapsed.count());
+
+      drivePlayer(
+        simulation, predictor.predict(simulation), random, serve_target);
+    }
+
+    result.query_us =
+      total_us / (static_cast<double>(timed_frames) *
+                static_cast<double>(queries_per_frame));
+    if (landing < 0)
+    {
+      std::printf("predictor: impossible landing\n");
+    }
+  }
+}
+
+/**
+ *   @brief   Checks the predictor against the simulation and times it.
+ *   @return  The process exit code, non zero if any predicted path
+ *            differed from the stepped game.
+ */
+int runPredictorCheck()
+{
+  struct Scenario
+  {
+    const char* name;
+    int columns;
+    int rows;
+  };
+  const Scenario scenarios[] = { { "level", 0, 0 },
+                                 { "arena", arena_columns, arena_rows } };
+
+  bool matched = true;
+  for (const auto& scenario : scenarios)
+  {
+    auto result = checkPaths(scenario.columns, scenario.rows);
+    timeQueries(scenario.columns, scenario.rows, result);
+    matched = matched && result.mismatches == 0 && result.paths > 0;
+
+    std::printf("predictor %-6s paths %5llu contacts %6llu mismatches %llu  "
+                "trace %7.2f us  query %6.3f us  frame %7.1f us  %s\n",
+                scenario.name,
+                static_cast<unsigned long long>(result.paths),
+                static_cast<unsigned long long>(result.contacts),
+                static_cast<unsigned long long>(result.mismatches),
+                result.average_trace_us,
+                result.query_us,
+                result.worst_frame_us,
+                result.query_us <= query_budget_us ? "within budget"
+                                                   : "over budget");
+  }
+
+  std::printf("predictor: paths %s the stepped simulation\n",
+              matched ? "match" : "DIFFER FROM");
+  return matched ? 0 : 1;
+}
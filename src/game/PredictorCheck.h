@@ -0,0 +1,10 @@
+#pragma once
+
+/**
+ *  Headless check of the ball predictor, run from the command line.
+ *  Plays the level and the arena with a player that moves to the
+ *  predicted landing point, checks every predicted path bounce for
+ *  bounce against the stepped simulation, and times a frame's worth of
+ *  queries against the per query budget.
+ */
+int runPredictorCheck();
@@ -0,0 +1,229 @@
+#include "RasterBench.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "SoftwareRenderer.h"
+#include "Simulation.h"
+#include "Viewport.h"
+
+namespace
+{
+  enum
+  {
+    frames = 120,
+    frame_width = 1280,
+    frame_height = 720,
+    text_lines = 12,
+    overdraw_sprites = 1000,
+    arena_columns = 500,
+    arena_rows = 200
+  };
+
+  const double frame_budget_ms = 1000.0 / 60.0;
+
+  /** Full size, and the lowest scale the render scale controller uses. */
+  const float render_scales[] = { 1.0F, 0.5F };
+
+  struct Scene
+  {
+    const char* name;
+    std::vector<DrawItem> items;
+  };
+
+  struct Run
+  {
+    double average_ms = 0;
+    std::size_t draws = 0;
+    std::uint64_t hash = 0;
+  };
+
+  /**
+   *   @brief   Makes a texture for each TextureId.
+   *   @details Flat colours with a soft, translucent border, so the
+   *            benchmark needs no asset files but still blends edges.
+   *   @return  void
+   */
+  void addTextures(SoftwareRenderer& renderer)
+  {
+    for (std::size_t i = 0; i < textureIndex(TextureId::COUNT); i++)
+    {
+      const auto& info = textureInfo(static_cast<TextureId>(i));
+      const auto w = static_cast<int>(info.width);
+      const auto h = static_cast<int>(info.height);
+
+      std::vector<std::uint8_t> rgba(static_cast<std::size_t>(w * h) * 4);
+      for (int y = 0; y < h; y++)
+      {
+        for (int x = 0; x < w; x++)
+        {
+          const int edge = std::min({ x, y, w - 1 - x, h - 1 - y });
+          auto* texel = rgba.data() + static_cast<std::size_t>(y * w + x) * 4;
+          texel[0] = static_cast<std::uint8_t>(40 + i * 30);
+          texel[1] = static_cast<std::uint8_t>(200 - i * 20);
+          texel[2] = static_cast<std::uint8_t>(90 + (x * 160) / w);
+          texel[3] = static_cast<std::uint8_t>(std::min(edge * 96, 255));
+        }
+      }
+      renderer.addTexture(info.name, w, h, rgba.data());
+    }
+  }
+
+  Scene captureScene(const char* name, int columns, int rows)
+  {
+    Simulation simulation;
+    simulation.setArena(columns, rows);
+    simulation.reset(frame_width, frame_height);
+
+    FrameSnapshot snapshot;
+    simulation.capture(snapshot);
+    return Scene{ name, snapshot.items };
+  }
+
+  /**
+   *   @brief   Scatters large, translucent gems over the screen.
+   *   @details A worst case for blending: every sprite is scaled and
+   *            most pixels are covered several times.
+   *   @return  The scene.
+   */
+  Scene overdrawScene()
+  {
+    Scene scene{ "overdraw", {} };
+    std::uint32_t state = 2024;
+    for (int i = 0; i < overdraw_sprites; i++)
+    {
+      state = state * 1664525U + 1013904223U;
+      DrawItem item;
+      item.texture = TextureId::GEM;
+      item.x = static_cast<float>((state >> 8) % frame_width) - 48;
+      item.y = static_cast<float>((state >> 20) % frame_height) - 46;
+      item.w = 96;
+      item.h = 92;
+      scene.items.push_back(item);
+    }
+    return scene;
+  }
+
+  /**
+   *   @brief   Draws a scene as render() would, with a screen of text.
+   *   @param   scale The render scale, as the game's controller sets it.
+   *   @return  The average frame time and the last frame's hash.
+   */
+  Run drawScene(const Scene& scene, unsigned int threads, float scale)
+  {
+    SoftwareRenderer renderer(threads);
+    renderer.init(
+      frame_width, frame_height, ASGE::Renderer::WindowMode::WINDOWED);
+    renderer.setClearColour(ASGE::COLOURS::BLACK);
+    renderer.setRenderScale(scale);
+    addTextures(renderer);
+
+    std::vector<std::unique_ptr<ASGE::Sprite>> sprites;
+    for (std::size_t i = 0; i < textureIndex(TextureId::COUNT); i++)
+    {
+      sprites.emplace_back(renderer.createUniqueSprite());
+      sprites.back()->loadTexture(textureInfo(static_cast<TextureId>(i)).name);
+    }
+
+    Viewport viewport(frame_width, frame_height);
+    viewport.setWindowSize(frame_width, frame_height);
+    viewport.setRenderScale(scale);
+
+    Run run;
+    const auto start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < frames; frame++)
+    {
+      renderer.preRender();
+      for (const auto& item : scene.items)
+      {
+        const auto rect = viewport.toWindow(item.x, item.y, item.w, item.h);
+        ASGE::Sprite& sprite = *sprites[textureIndex(item.texture)];
+        sprite.xPos(rect.x);
+        sprite.yPos(rect.y);
+        sprite.width(rect.w);
+        sprite.height(rect.h);
+        renderer.renderSprite(sprite);
+      }
+      for (int line = 0; line < text_lines; line++)
+      {
+        renderer.renderText("FRAME " + std::to_string(frame) + "  LINE " +
+                              std::to_string(line) + "  SCORE: 12345",
+                            10,
+                            200 + line * 20,
+                            0.6F,
+                            ASGE::COLOURS::YELLOW);
+      }
+      renderer.postRender();
+    }
+    const std::chrono::duration<double, std::milli> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+    run.average_ms = elapsed.count() / static_cast<double>(frames);
+    run.draws = renderer.getStats().draws;
+    run.hash = renderer.hash();
+    return run;
+  }
+}
+
+/**
+ *   @brief   Times 720p frames by scene, render scale and thread count.
+ *   @return  The process exit code, non zero if any thread count drew
+ *            different pixels.
+ */
+int runRasterBenchmark()
+{
+  const Scene scenes[] = { captureScene("level", 0, 0),
+                           captureScene("arena", arena_columns, arena_rows),
+                           overdrawScene() };
+
+  // at least 4, so the determinism check always covers parallel tiles
+  const unsigned int hardware =
+    std::max(std::thread::hardware_concurrency(), 4U);
+  std::vector<unsigned int> thread_counts;
+  for (unsigned int threads = 1; threads < hardware; threads *= 2)
+  {
+    thread_counts.push_back(threads);
+  }
+  thread_counts.push_back(hardware);
+
+  bool deterministic = true;
+  for (const auto& scene : scenes)
+  {
+    for (const float scale : render_scales)
+    {
+      std::uint64_t reference = 0;
+      for (const auto threads : thread_counts)
+      {
+        const auto run = drawScene(scene, threads, scale);
+        if (threads == thread_counts.front())
+        {
+          reference = run.hash;
+        }
+        const bool matched = run.hash == reference;
+        deterministic = deterministic && matched;
+
+        std::printf("raster %-8s scale %.2f %2u threads %8.3f ms  "
+                    "%7.1f frames/s  draws %5zu  %s%s\n",
+                    scene.name,
+                    static_cast<double>(scale),
+                    threads,
+                    run.average_ms,
+                    1000.0 / run.average_ms,
+                    run.draws,
+                    run.average_ms <= frame_budget_ms ? "within frame"
+                                                      : "over frame",
+                    matched ? "" : "  PIXELS DIFFER");
+      }
+    }
+  }
+
+  std::printf("raster: frames %s across thread counts\n",
+              deterministic ? "match" : "DIFFER");
+  return deterministic ? 0 : 1;
+}
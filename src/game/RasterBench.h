@@ -0,0 +1,10 @@
+#pragma once
+
+/**
+ *  Headless benchmark of the software renderer, run from the command
+ *  line. Draws 720p frames of the level, the arena and a scene of
+ *  overlapping translucent sprites at full and half render scale with
+ *  each thread count, and checks that every thread count draws the same
+ *  pixels.
+ */
+int runRasterBenchmark();
@@ -0,0 +1,171 @@
+#include "RenderScaleCheck.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+
+#include "RenderScaleController.h"
+
+namespace
+{
+  enum
+  {
+    phase_frames = 1200,
+    jitter_steps = 200 /**< Jitter is drawn in 1/100ths of jitter_ms. */
+  };
+
+  const double jitter_ms = 1.0;
+
+  /** Small deterministic generator, so every run sees the same trace. */
+  struct Lcg
+  {
+    std::uint32_t state = 4242;
+
+    int next(int range)
+    {
+      state = state * 1664525U + 1013904223U;
+      return static_cast<int>((state >> 8) % static_cast<std::uint32_t>(range));
+    }
+  };
+
+  /** A machine, given by its frame time at full scale. */
+  struct Phase
+  {
+    const char* name;
+    double full_scale_ms;
+  };
+
+  struct Result
+  {
+    int downs = 0;
+    int ups = 0;
+    float start_scale = 1.0F;
+    float end_scale = 1.0F;
+    std::size_t last_change = 0; /**< Frame of the phase, 0 if none. */
+  };
+
+  /**
+   *   @brief   Plays a phase of frames through the controller.
+   *   @details Frame time is modelled as pixel bound, so it scales with
+   *            the square of the render scale, plus a little jitter.
+   *   @param   since_change Frames since the last change, carried
+   *            across phases.
+   *   @param   closest_changes Lowered to the fewest frames seen
+   *            between two changes.
+   *   @return  The changes made in the phase.
+   */
+  Result playPhase(RenderScaleController& controller,
+                   const Phase& phase,
+                   Lcg& random,
+                   std::size_t& since_change,
+                   std::size_t& closest_changes)
+  {
+    Result result;
+    result.start_scale = controller.getScale();
+    for (std::size_t frame = 1; frame <= phase_frames; frame++)
+    {
+      const double scale = controller.getScale();
+      const double jitter =
+        (random.next(jitter_steps) - jitter_steps / 2) * jitter_ms / 100.0;
+      const auto decision =
+        controller.onFrame(phase.full_scale_ms * scale * scale + jitter);
+
+      since_change++;
+      if (decision.action == RenderScaleController::Action::KEEP)
+      {
+        continue;
+      }
+      closest_changes = std::min(closest_changes, since_change);
+      since_change = 0;
+      result.last_change = frame;
+      if (decision.action == RenderScaleController::Action::DOWN)
+      {
+        result.downs++;
+      }
+      else
+      {
+        result.ups++;
+      }
+    }
+    result.end_scale = controller.getScale();
+    return result;
+  }
+}
+
+/**
+ *   @brief   Runs the controller over a slow, steady and fast trace.
+ *   @details The slow machine must scale down and settle. The steady
+ *            one costs, at the scale the slow one settled on, between
+ *            the thresholds for stepping up and down, so the scale must
+ *            hold. The fast one must scale back to full. No two changes
+ *            may come closer than a window and a cooldown apart.
+ *   @return  The process exit code, non zero if any phase misbehaved.
+ */
+int runRenderScaleCheck()
+{
+  RenderScaleController controller;
+  const auto& config = controller.getConfig();
+
+  Lcg random;
+  // no change yet, so the first one is not measured from the start
+  std::size_t since_change = std::numeric_limits<std::size_t>::max() / 2;
+  std::size_t closest_changes = std::numeric_limits<std::size_t>::max();
+  const auto play = [&](const Phase& phase) {
+    const auto result = playPhase(
+      controller, phase, random, since_change, closest_changes);
+    std::printf("render scale %-6s %6.2f ms  down %d  up %d  "
+                "scale %.3f -> %.3f  last change at frame %zu\n",
+                phase.name,
+                phase.full_scale_ms,
+                result.downs,
+                result.ups,
+                static_cast<double>(result.start_scale),
+                static_cast<double>(result.end_scale),
+                result.last_change);
+    return result;
+  };
+
+  const auto slow = play(Phase{ "slow", config.budget_ms * 1.8 });
+
+  // halfway between the frame times that would step up and down
+  const double scale = slow.end_scale;
+  const double ratio =
+    std::min(config.max_scale, slow.end_scale + config.step) / scale;
+  const double up_ms = config.budget_ms * config.under_budget / ratio / ratio;
+  const double down_ms = config.budget_ms * config.over_budget;
+  const auto steady =
+    play(Phase{ "steady", (up_ms + down_ms) / 2 / scale / scale });
+
+  const auto fast = play(Phase{ "fast", config.budget_ms * 0.5 });
+
+  const bool dropped = slow.downs > 0 && slow.ups == 0 &&
+                       slow.end_scale < config.max_scale &&
+                       slow.last_change < phase_frames / 2;
+  const bool held = steady.downs == 0 && steady.ups == 0;
+  const bool recovered = fast.ups > 0 && fast.downs == 0 &&
+                         fast.end_scale == config.max_scale &&
+                         fast.last_change < phase_frames / 2;
+  const bool spaced = closest_changes >= config.window + config.cooldown;
+
+  const char* verdict = "drops, holds and recovers";
+  if (!dropped)
+  {
+    verdict = "DID NOT SETTLE LOWER on the slow trace";
+  }
+  else if (!held)
+  {
+    verdict = "DID NOT HOLD between the thresholds";
+  }
+  else if (!recovered)
+  {
+    verdict = "DID NOT RECOVER on the fast trace";
+  }
+  else if (!spaced)
+  {
+    verdict = "CHANGED FASTER than the window and cooldown allow";
+  }
+  std::printf("render scale: %s\n", verdict);
+  return dropped && held && recovered && spaced ? 0 : 1;
+}
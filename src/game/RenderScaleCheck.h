@@ -0,0 +1,9 @@
+#pragma once
+
+/**
+ *  Headless check of the render scale controller, run from the command
+ *  line. Feeds it synthetic frame times from a slow machine, then a
+ *  fast one, then one near the budget, and checks that the scale drops,
+ *  recovers and holds without oscillating.
+ */
+int runRenderScaleCheck();
@@ -0,0 +1,136 @@
+#include "RenderScaleController.h"
+
+#include <algorithm>
+
+/**
+ *   @brief   Constructor.
+ *   @details Starts at the maximum scale.
+ *   @param   settings The budget, thresholds and scale limits.
+ */
+RenderScaleController::RenderScaleController(
+  const RenderScaleConfig& settings) :
+  config(settings)
+{
+  config.window = std::max<std::size_t>(1, config.window);
+  samples.resize(config.window);
+  reset();
+}
+
+/**
+ *   @brief   Records a frame and possibly changes the scale.
+ *   @details Scaling down happens when the rolling average exceeds the
+ *            budget. Scaling up happens when the average, adjusted for
+ *            the extra pixels at the next step, fits well inside it.
+ *   @param   frame_ms How long the frame took, in milliseconds.
+ *   @return  The decision made for this frame.
+ */
+RenderScaleController::Decision RenderScaleController::onFrame(double frame_ms)
+{
+  frame++;
+
+  Decision decision;
+  decision.frame = frame;
+  decision.previous_scale = scale;
+  decision.scale = scale;
+
+  if (cooldown_left > 0)
+  {
+    cooldown_left--;
+    decision.average_ms = getAverageMs();
+    return decision;
+  }
+
+  if (sample_count == config.window)
+  {
+    sample_sum -= samples[next_sample];
+  }
+  else
+  {
+    sample_count++;
+  }
+  samples[next_sample] = frame_ms;
+  sample_sum += frame_ms;
+  next_sample = (next_sample + 1) % config.window;
+
+  decision.average_ms = getAverageMs();
+  if (sample_count < config.window)
+  {
+    return decision;
+  }
+
+  if (decision.average_ms > config.budget_ms * config.over_budget &&
+      scale > config.min_scale)
+  {
+    decision.action = Action::DOWN;
+    decision.scale = std::max(config.min_scale, scale - config.step);
+  }
+  else if (scale < config.max_scale)
+  {
+    // pixel cost grows with the square of the scale
+    const float next = std::min(config.max_scale, scale + config.step);
+    const double ratio = static_cast<double>(next) / scale;
+    if (decision.average_ms * ratio * ratio <
+        config.budget_ms * config.under_budget)
+    {
+      decision.action = Action::UP;
+      decision.scale = next;
+    }
+  }
+
+  if (decision.action != Action::KEEP)
+  {
+    scale = decision.scale;
+    cooldown_left = config.cooldown;
+    restartWindow();
+    if (logger)
+    {
+      logger(decision);
+    }
+  }
+
+  return decision;
+}
+
+/**
+ *   @brief   Returns to the maximum scale and forgets all samples.
+ *   @return  void
+ */
+void RenderScaleController::reset()
+{
+  scale = config.max_scale;
+  frame = 0;
+  cooldown_left = 0;
+  restartWindow();
+}
+
+/**
+ *   @brief   Sets the function told about every scale change.
+ *   @param   log_fn Called with each decision that changes the scale.
+ *   @return  void
+ */
+void RenderScaleController::setLogger(Logger log_fn)
+{
+  logger = std::move(log_fn);
+}
+
+float RenderScaleController::getScale() const
+{
+  return scale;
+}
+
+double RenderScaleController::getAverageMs() const
+{
+  return sample_count ? sample_sum / static_cast<double>(sample_count) : 0.0;
+}
+
+const RenderScaleConfig& RenderScaleController::getConfig() const
+{
+  return config;
+}
+
+void RenderScaleController::restartWindow()
+{
+  next_sample = 0;
+  sample_count = 0;
+  sample_sum = 0;
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+/**
+ *  Tuning for the RenderScaleController.
+ *  Frame times are in milliseconds and scales are fractions of the
+ *  output resolution.
+ */
+struct RenderScaleConfig
+{
+  double budget_ms = 1000.0 / 60.0; /**< Target frame time. */
+  double over_budget = 1.05;  /**< Scale down above budget * over_budget. */
+  double under_budget = 0.80; /**< Scale up when the predicted frame time
+                                   at the next scale is below this. */
+  std::size_t window = 60;    /**< Frames averaged before deciding. */
+  std::size_t cooldown = 90;  /**< Frames ignored after a change. */
+  float min_scale = 0.5F;
+  float max_scale = 1.0F;
+  float step = 0.125F;
+};
+
+/**
+ *  Chooses the internal render scale from recent frame times.
+ *  Frame times are fed in one at a time, which keeps the controller
+ *  independent of any clock or GPU so it can be driven by a synthetic
+ *  trace. A change is only made once a full window of frames has been
+ *  seen, and a cooldown plus separate up/down thresholds stop the scale
+ *  oscillating around the budget.
+ */
+class RenderScaleController
+{
+ public:
+  enum class Action
+  {
+    KEEP,
+    DOWN,
+    UP
+  };
+
+  struct Decision
+  {
+    Action action = Action::KEEP;
+    float previous_scale = 1.0F;
+    float scale = 1.0F;
+    double average_ms = 0;
+    std::size_t frame = 0;
+  };
+
+  using Logger = std::function<void(const Decision&)>;
+
+  explicit RenderScaleController(
+    const RenderScaleConfig& config = RenderScaleConfig());
+
+  Decision onFrame(double frame_ms);
+  void reset();
+
+  void setLogger(Logger logger);
+  float getScale() const;
+  double getAverageMs() const;
+  const RenderScaleConfig& getConfig() const;
+
+ private:
+  void restartWindow();
+
+  RenderScaleConfig config;
+  Logger logger;
+
+  std::vector<double> samples;
+  std::size_t next_sample = 0;
+  std::size_t sample_count = 0;
+  double sample_sum = 0;
+
+  std::size_t frame = 0;
+  std::size_t cooldown_left = 0;
+  float scale = 1.0F;
+};
@@ -0,0 +1,344 @@
+#include "ScriptScheduler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+/**
+ *   @brief   Continues the awaiting script once a script finishes.
+ *   @details A spawned script has nothing to continue; control then
+ *            returns to the scheduler, which destroys it.
+ */
+std::coroutine_handle<>
+Task::FinalAwaiter::await_suspend(Handle handle) noexcept
+{
+  const auto next = handle.promise().continuation;
+  return next ? next : std::noop_coroutine();
+}
+
+Task::Task(Task&& other) noexcept : handle(std::exchange(other.handle, {})) {}
+
+Task& Task::operator=(Task&& other) noexcept
+{
+  if (this != &other)
+  {
+    if (handle)
+    {
+      handle.destroy();
+    }
+    handle = std::exchange(other.handle, {});
+  }
+  return *this;
+}
+
+Task::~Task()
+{
+  if (handle)
+  {
+    handle.destroy();
+  }
+}
+
+bool Task::await_ready() const noexcept
+{
+  return !handle || handle.done();
+}
+
+/**
+ *   @brief   Starts this script on behalf of an awaiting script.
+ *   @details The script inherits the caller's root, so timers and
+ *            events it waits on are cancelled along with the caller.
+ *   @return  The script to run next.
+ */
+Task::Handle Task::await_suspend(Handle caller) noexcept
+{
+  handle.promise().continuation = caller;
+  handle.promise().root = caller.promise().root;
+  return handle;
+}
+
+/**
+ *   @brief   Gives up ownership of the coroutine.
+ *   @return  The coroutine, which the caller must destroy.
+ */
+Task::Handle Task::release()
+{
+  return std::exchange(handle, {});
+}
+
+ScriptScheduler::SleepAwaiter::SleepAwaiter(ScriptScheduler& owner,
+                                            double wait_seconds) :
+  scheduler(owner),
+  seconds(wait_seconds)
+{
+}
+
+void ScriptScheduler::SleepAwaiter::await_suspend(Task::Handle handle)
+{
+  scheduler.timers.push_back(Timer{ scheduler.clock + seconds,
+                                    scheduler.next_order++,
+                                    handle.promise().root,
+                                    handle });
+  std::push_heap(
+    scheduler.timers.begin(), scheduler.timers.end(), &wakesLater);
+}
+
+ScriptScheduler::EventAwaiter::EventAwaiter(ScriptScheduler& owner,
+                                            std::uint64_t event_key) :
+  scheduler(owner),
+  event(event_key)
+{
+}
+
+void ScriptScheduler::EventAwaiter::await_suspend(Task::Handle handle)
+{
+  std::lock_guard<std::mutex> lock(scheduler.mutex);
+  scheduler.waiting[event].push_back(
+    Waiter{ handle.promise().root, handle, &value, 0 });
+}
+
+ScriptScheduler::~ScriptScheduler()
+{
+  clear();
+}
+
+/**
+ *   @brief   Starts a script.
+ *   @details The script runs straight away until it first suspends.
+ *   @param   task The script, as returned by calling a coroutine.
+ *   @return  An id for cancelling the script.
+ */
+TaskId ScriptScheduler::spawn(Task task)
+{
+  const TaskId id = next_id++;
+  const auto handle = task.release();
+  if (!handle)
+  {
+    return id;
+  }
+
+  handle.promise().root = id;
+  tasks.emplace(id, handle);
+  stats.spawned++;
+  resume(id, handle);
+  return id;
+}
+
+/**
+ *   @brief   Stops a script and destroys it.
+ *   @details Any script it is awaiting is destroyed with it. A script
+ *            must not cancel itself.
+ *   @return  False if the script had already finished.
+ */
+bool ScriptScheduler::cancel(TaskId id)
+{
+  auto found = tasks.find(id);
+  if (found == tasks.end())
+  {
+    return false;
+  }
+
+  const auto removed = std::remove_if(
+    timers.begin(), timers.end(), [id](const Timer& timer) {
+      return timer.task == id;
+    });
+  if (removed != timers.end())
+  {
+    timers.erase(removed, timers.end());
+    std::make_heap(timers.begin(), timers.end(), &wakesLater);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    const auto is_task = [id](const Waiter& waiter) {
+      return waiter.task == id;
+    };
+    for (auto it = waiting.begin(); it != waiting.end();)
+    {
+      auto& waiters = it->second;
+      waiters.erase(std::remove_if(waiters.begin(), waiters.end(), is_task),
+                    waiters.end());
+      it = waiters.empty() ? waiting.erase(it) : std::next(it);
+    }
+    ready.erase(std::remove_if(ready.begin(), ready.end(), is_task),
+                ready.end());
+  }
+
+  found->second.destroy();
+  tasks.erase(found);
+  return true;
+}
+
+/**
+ *   @brief   Destroys every script.
+ *   @return  void
+ */
+void ScriptScheduler::clear()
+{
+  for (auto& task : tasks)
+  {
+    task.second.destroy();
+  }
+  tasks.clear();
+  timers.clear();
+
+  std::lock_guard<std::mutex> lock(mutex);
+  waiting.clear();
+  ready.clear();
+  has_ready = false;
+}
+
+bool ScriptScheduler::isRunning(TaskId id) const
+{
+  return tasks.find(id) != tasks.end();
+}
+
+/**
+ *   @brief   Suspends the calling script.
+ *   @param   seconds Scheduler time to wait. Zero does not suspend.
+ *   @return  The awaitable to co_await.
+ */
+ScriptScheduler::SleepAwaiter ScriptScheduler::sleep(double seconds)
+{
+  return SleepAwaiter(*this, seconds);
+}
+
+/**
+ *   @brief   Suspends the calling script until an event is signalled.
+ *   @details co_await yields the value passed to signal().
+ *   @return  The awaitable to co_await.
+ */
+ScriptScheduler::EventAwaiter ScriptScheduler::waitFor(std::uint64_t event)
+{
+  return EventAwaiter(*this, event);
+}
+
+/**
+ *   @brief   Wakes every script waiting on an event.
+ *   @details Thread safe. The scripts resume on the next update(). A
+ *            signal nobody is waiting for is dropped.
+ *   @param   event The event's key.
+ *   @param   value Passed to each woken script.
+ *   @return  void
+ */
+void ScriptScheduler::signal(std::uint64_t event, int value)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  auto found = waiting.find(event);
+  if (found == waiting.end())
+  {
+    return;
+  }
+
+  for (auto& waiter : found->second)
+  {
+    waiter.value = value;
+    ready.push_back(waiter);
+  }
+  waiting.erase(found);
+  has_ready = true;
+}
+
+/**
+ *   @brief   Advances time and resumes the scripts that are due.
+ *   @details Timers are resumed in wake order, then signalled scripts
+ *            in the order they were signalled. With nothing due this
+ *            only compares the earliest timer and reads one flag.
+ *   @param   seconds Time since the last update.
+ *   @return  The number of scripts resumed.
+ */
+std::size_t ScriptScheduler::update(double seconds)
+{
+  clock += seconds;
+  std::size_t resumed = 0;
+
+  while (!timers.empty() && timers.front().wake <= clock)
+  {
+    std::pop_heap(timers.begin(), timers.end(), &wakesLater);
+    const Timer timer = timers.back();
+    timers.pop_back();
+    resume(timer.task, timer.handle);
+    resumed++;
+  }
+
+  if (has_ready.load(std::memory_order_acquire))
+  {
+    std::vector<Waiter> woken;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      std::swap(woken, ready);
+      has_ready = false;
+    }
+
+    for (const auto& waiter : woken)
+    {
+      // scripts woken earlier in this loop may have cancelled this one
+      if (isRunning(waiter.task))
+      {
+        *waiter.slot = waiter.value;
+        resume(waiter.task, waiter.handle);
+        resumed++;
+      }
+    }
+  }
+
+  stats.last_update_resumes = resumed;
+  return resumed;
+}
+
+double ScriptScheduler::now() const
+{
+  return clock;
+}
+
+/**
+ *   @brief   The scheduler's statistics.
+ *   @details The resume cost is an exponential moving average.
+ *   @return  A copy of the statistics.
+ */
+ScriptScheduler::Stats ScriptScheduler::getStats() const
+{
+  Stats copy = stats;
+  copy.tasks = tasks.size();
+  copy.sleeping = timers.size();
+
+  std::lock_guard<std::mutex> lock(mutex);
+  copy.waiting = ready.size();
+  for (const auto& event : waiting)
+  {
+    copy.waiting += event.second.size();
+  }
+  return copy;
+}
+
+bool ScriptScheduler::wakesLater(const Timer& lhs, const Timer& rhs)
+{
+  return lhs.wake > rhs.wake || (lhs.wake == rhs.wake && lhs.order > rhs.order);
+}
+
+/**
+ *   @brief   Resumes a suspended script and times it.
+ *   @details Destroys the script's root once it has finished.
+ *   @param   id The script's root.
+ *   @param   handle The coroutine that suspended.
+ *   @return  void
+ */
+void ScriptScheduler::resume(TaskId id, std::coroutine_handle<> handle)
+{
+  const auto start = std::chrono::steady_clock::now();
+  handle.resume();
+  const std::chrono::duration<double, std::micro> elapsed =
+    std::chrono::steady_clock::now() - start;
+
+  stats.resumes++;
+  stats.average_resume_us +=
+    (elapsed.count() - stats.average_resume_us) * 0.05;
+  stats.max_resume_us = std::max(stats.max_resume_us, elapsed.count());
+
+  auto found = tasks.find(id);
+  if (found != tasks.end() && found->second.done())
+  {
+    found->second.destroy();
+    tasks.erase(found);
+  }
+}
@@ -0,0 +1,166 @@
+#pragma once
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+using TaskId = std::uint64_t;
+
+/**
+ *  A script: a coroutine run by a ScriptScheduler.
+ *  Scripts suspend with co_await on a timer, an event or another script
+ *  and are only resumed once that completes, so a suspended script
+ *  costs nothing per frame. Awaiting a script runs it as part of the
+ *  caller, which lets sequences be composed from smaller ones.
+ */
+class Task
+{
+ public:
+  struct promise_type;
+  using Handle = std::coroutine_handle<promise_type>;
+
+  struct FinalAwaiter
+  {
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(Handle handle) noexcept;
+    void await_resume() const noexcept {}
+  };
+
+  struct promise_type
+  {
+    Task get_return_object() { return Task(Handle::from_promise(*this)); }
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    FinalAwaiter final_suspend() const noexcept { return {}; }
+    void return_void() const noexcept {}
+    void unhandled_exception() const noexcept { std::terminate(); }
+
+    std::coroutine_handle<> continuation;
+    TaskId root = 0; /**< The script spawned with the scheduler. */
+  };
+
+  Task() = default;
+  Task(Task&& other) noexcept;
+  Task& operator=(Task&& other) noexcept;
+  Task(const Task&) = delete;
+  Task& operator=(const Task&) = delete;
+  ~Task();
+
+  bool await_ready() const noexcept;
+  Handle await_suspend(Handle caller) noexcept;
+  void await_resume() const noexcept {}
+
+  Handle release();
+
+ private:
+  explicit Task(Handle coroutine) : handle(coroutine) {}
+
+  Handle handle;
+};
+
+/**
+ *  Runs scripts on the thread that calls update().
+ *  Sleeping scripts are kept in a heap ordered by wake time, so update()
+ *  only touches scripts that are due. Scripts waiting on an event are
+ *  woken by signal(), which may be called from any thread; they resume
+ *  on the next update(). Events are identified by a 64 bit key chosen
+ *  by the owner and carry an int to the scripts they wake.
+ */
+class ScriptScheduler
+{
+ public:
+  struct Stats
+  {
+    std::size_t tasks = 0;
+    std::size_t sleeping = 0;
+    std::size_t waiting = 0;
+    std::uint64_t spawned = 0;
+    std::uint64_t resumes = 0;
+    std::size_t last_update_resumes = 0;
+    double average_resume_us = 0;
+    double max_resume_us = 0;
+  };
+
+  class SleepAwaiter
+  {
+   public:
+    SleepAwaiter(ScriptScheduler& owner, double wait_seconds);
+
+    bool await_ready() const noexcept { return seconds <= 0; }
+    void await_suspend(Task::Handle handle);
+    void await_resume() const noexcept {}
+
+   private:
+    ScriptScheduler& scheduler;
+    double seconds;
+  };
+
+  class EventAwaiter
+  {
+   public:
+    EventAwaiter(ScriptScheduler& owner, std::uint64_t event_key);
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(Task::Handle handle);
+    int await_resume() const noexcept { return value; }
+
+   private:
+    ScriptScheduler& scheduler;
+    std::uint64_t event;
+    int value = 0;
+  };
+
+  ScriptScheduler() = default;
+  ScriptScheduler(const ScriptScheduler&) = delete;
+  ScriptScheduler& operator=(const ScriptScheduler&) = delete;
+  ~ScriptScheduler();
+
+  TaskId spawn(Task task);
+  bool cancel(TaskId id);
+  void clear();
+  bool isRunning(TaskId id) const;
+
+  SleepAwaiter sleep(double seconds);
+  EventAwaiter waitFor(std::uint64_t event);
+  void signal(std::uint64_t event, int value = 0);
+
+  std::size_t update(double seconds);
+  double now() const;
+  Stats getStats() const;
+
+ private:
+  struct Timer
+  {
+    double wake = 0;
+    std::uint64_t order = 0;
+    TaskId task = 0;
+    std::coroutine_handle<> handle;
+  };
+
+  struct Waiter
+  {
+    TaskId task = 0;
+    std::coroutine_handle<> handle;
+    int* slot = nullptr;
+    int value = 0;
+  };
+
+  static bool wakesLater(const Timer& lhs, const Timer& rhs);
+  void resume(TaskId id, std::coroutine_handle<> handle);
+
+  std::unordered_map<TaskId, Task::Handle> tasks;
+  std::vector<Timer> timers; /**< Min heap on wake time. */
+  double clock = 0;
+  TaskId next_id = 1;
+  std::uint64_t next_order = 0;
+
+  mutable std::mutex mutex;
+  std::unordered_map<std::uint64_t, std::vector<Waiter>> waiting;
+  std::vector<Waiter> ready;
+  std::atomic<bool> has_ready{ false };
+
+  Stats stats;
+};
@@ -0,0 +1,880 @@
+#include "Simulation.h"
+
+#include <algorithm>
+#include <cmath>
+
+using std::abs;
+
+/**
+ *   @brief   Constructor.
+ *   @details The systems are registered once; reset() builds a level.
+ */
+Simulation::Simulation() : scheduler(pool)
+{
+  registerSystems();
+}
+
+/**
+ *   @brief   Plays a large grid of multi-hit bricks instead of the level.
+ *   @details Takes effect from the next reset() or restart().
+ *   @param   columns The width of the arena in bricks, or 0 to play the
+ *            level.
+ *   @param   rows The height of the arena in bricks.
+ *   @return  void
+ */
+void Simulation::setArena(int columns, int rows)
+{
+  arena_columns = rows > 0 ? std::max(columns, 0) : 0;
+  arena_rows = arena_columns > 0 ? rows : 0;
+}
+
+/**
+ *   @brief   Starts a new game.
+ *   @details Destroys every entity and spawns a fresh level.
+ *   @param   width The width of the play area.
+ *   @param   height The height of the play area.
+ *   @param   layout The bricks and gems to spawn.
+ *   @return  void
+ */
+void Simulation::reset(float width, float height, const LevelData& layout)
+{
+  game_width = toScalar(width);
+  game_height = toScalar(height);
+  level = layout;
+  accumulator = 0;
+  layout_version++;
+
+  scripts.clear();
+  world.clear();
+  session = world.create(Session{});
+
+  if (arena_columns > 0)
+  {
+    // the arena replaces the level's bricks and fills the top half
+    brick_rows.clear();
+    arena.generate(arena_columns,
+                   arena_rows,
+                   width / static_cast<float>(arena_columns),
+                   height / 2 / static_cast<float>(arena_rows),
+                   arena_seed,
+                   arena_explosive_percent);
+  }
+  else
+  {
+    arena.clear();
+    brick_rows.assign(level.rows.size(), std::vector<Entity>());
+    for (std::size_t row = 0; row < level.rows.size(); row++)
+    {
+      spawnRow(static_cast<int>(row));
+    }
+    spawnGems();
+  }
+
+  const auto& paddle_info = textureInfo(TextureId::PADDLE);
+  const Size paddle_size{ toScalar(paddle_info.width),
+                          toScalar(paddle_info.height) };
+  paddle = world.create(Position{ game_width / Scalar(2) -
+                                    paddle_size.w / Scalar(2),
+                                  game_height - Scalar(50) },
+                        paddle_size,
+                        Velocity{},
+                        Renderable{ TextureId::PADDLE },
+                        Paddle{});
+
+  const auto& ball_info = textureInfo(TextureId::BALL);
+  ball = world.create(Position{},
+                      Size{ toScalar(ball_info.width),
+                            toScalar(ball_info.height) },
+                      Velocity{},
+                      Renderable{ TextureId::BALL },
+                      Ball{});
+}
+
+/**
+ *   @brief   Starts a new game on the current level.
+ *   @details Keeps any edits applied with applyLevel().
+ *   @return  void
+ */
+void Simulation::restart()
+{
+  const LevelData layout = level;
+  reset(toFloat(game_width), toFloat(game_height), layout);
+}
+
+/**
+ *   @brief   Swaps in an edited level without restarting the game.
+ *   @details Only the rows named in the diff are respawned. Gems keep
+ *            their state unless the gem list itself changed, but any
+ *            gem triggered by a respawned row is pointed at the new
+ *            brick. Must be called between steps. An arena game only
+ *            keeps the edit for when the level is next played.
+ *   @param   layout The edited level.
+ *   @param   diff The rows and gems that differ from the current level.
+ *   @return  void
+ */
+void Simulation::applyLevel(const LevelData& layout, const LevelDiff& diff)
+{
+  level = layout;
+  if (arena_columns > 0)
+  {
+    return;
+  }
+  layout_version++;
+
+  // gems still waiting on a brick that is about to be respawned
+  std::vector<Entity> waiting;
+  world.each<Gem>([&](Entity gem, Gem& data) {
+    if (world.isAlive(data.trigger) &&
+        std::find(diff.rows.begin(), diff.rows.end(), data.trigger_row) !=
+          diff.rows.end())
+    {
+      waiting.push_back(gem);
+    }
+  });
+
+  for (int row : diff.rows)
+  {
+    if (row < static_cast<int>(brick_rows.size()))
+    {
+      for (const auto& brick : brick_rows[static_cast<std::size_t>(row)])
+      {
+        world.destroy(brick);
+      }
+    }
+  }
+
+  brick_rows.resize(level.rows.size());
+  for (int row : diff.rows)
+  {
+    if (row < static_cast<int>(level.rows.size()))
+    {
+      spawnRow(row);
+    }
+  }
+
+  if (diff.gems)
+  {
+    std::vector<Entity> gems;
+    world.each<Gem>([&gems](Entity gem, Gem&) { gems.push_back(gem); });
+    for (const auto& gem : gems)
+    {
+      scripts.cancel(world.get<Gem>(gem)->release_script);
+      world.destroy(gem);
+    }
+    spawnGems();
+    return;
+  }
+
+  for (const auto& gem : waiting)
+  {
+    auto* data = world.get<Gem>(gem);
+    data->trigger = brickAt(data->trigger_row, data->trigger_column);
+    scripts.cancel(data->release_script);
+    data->release_script = scripts.spawn(releaseGem(gem, data->trigger));
+  }
+}
+
+/**
+ *   @brief   Advances the simulation by elapsed wall clock time.
+ *   @details Runs as many fixed steps as fit in the time accumulated so
+ *            far. After a long stall at most max_steps_per_advance are
+ *            run and the rest of the backlog is dropped.
+ *   @param   seconds Time since the last call.
+ *   @return  The number of steps run.
+ */
+int Simulation::advance(double seconds)
+{
+  const double step_seconds = 1.0 / static_cast<double>(steps_per_second);
+  accumulator += seconds;
+
+  int steps = 0;
+  while (accumulator >= step_seconds && steps < max_steps_per_advance)
+  {
+    step();
+    accumulator -= step_seconds;
+    steps++;
+  }
+  if (steps == max_steps_per_advance)
+  {
+    accumulator = std::min(accumulator, step_seconds);
+  }
+  return steps;
+}
+
+/**
+ *   @brief   Runs a single fixed step of 1 / steps_per_second.
+ *   @details Gems caught during the step are scored once the systems
+ *            are done. Scripts woken by the systems resume at the end
+ *            of the step.
+ *   @return  void
+ */
+void Simulation::step()
+{
+  scheduler.run(world, toFloat(step_dt));
+
+  auto* progress = world.get<Session>(session);
+  if (progress && gem_pickups.points != 0)
+  {
+    progress->score += gem_pickups.points;
+    totals.points += static_cast<std::uint64_t>(gem_pickups.points);
+  }
+  gem_pickups = GemPickups{};
+
+  scripts.update(1.0 / static_cast<double>(steps_per_second));
+  step_count++;
+}
+
+/**
+ *   @brief   Moves the paddle.
+ *   @param   direction -1 for left, 1 for right and 0 to stop.
+ *   @return  void
+ */
+void Simulation::setPaddleDirection(int direction)
+{
+  auto* velocity = world.get<Velocity>(paddle);
+  auto* paddle_data = world.get<Paddle>(paddle);
+  if (velocity && paddle_data)
+  {
+    velocity->x = Scalar(direction) * paddle_data->speed;
+  }
+}
+
+/**
+ *   @brief   Launches the ball from the paddle.
+ *   @details Has no effect when the ball is already in play.
+ *   @return  void
+ */
+void Simulation::serve()
+{
+  auto* ball_data = world.get<Ball>(ball);
+  auto* velocity = world.get<Velocity>(ball);
+  if (ball_data && velocity && !ball_data->served)
+  {
+    ball_data->served = true;
+    velocity->x = ball_data->serve_x;
+    velocity->y = ball_data->serve_y;
+  }
+}
+
+int Simulation::getLives()
+{
+  auto* data = world.get<Session>(session);
+  return data ? data->lives : 0;
+}
+
+int Simulation::getScore()
+{
+  auto* data = world.get<Session>(session);
+  return data ? data->score : 0;
+}
+
+bool Simulation::isWon() const
+{
+  return world.count<Brick>() == 0 && arena.getRemaining() == 0;
+}
+
+bool Simulation::isLost()
+{
+  return getLives() <= 0;
+}
+
+/**
+ *   @brief   The paddle's position and velocity.
+ *   @return  The state needed to draw the paddle ahead of the steps.
+ */
+PaddleState Simulation::getPaddleState()
+{
+  PaddleState state;
+  const auto* pos = world.get<Position>(paddle);
+  const auto* size = world.get<Size>(paddle);
+  const auto* velocity = world.get<Velocity>(paddle);
+  const auto* paddle_data = world.get<Paddle>(paddle);
+  if (pos && size && velocity && paddle_data)
+  {
+    state.x = toFloat(pos->x);
+    state.max_x = toFloat(game_width - size->w);
+    state.speed = toFloat(paddle_data->speed);
+    state.velocity = toFloat(velocity->x);
+  }
+  state.unsimulated = accumulator;
+  return state;
+}
+
+/**
+ *   @brief   The ball's position and velocity.
+ *   @details An unserved ball moves as if it were served now.
+ *   @return  The state needed to predict the ball's path.
+ */
+BallState Simulation::getBallState()
+{
+  BallState state;
+  const auto* pos = world.get<Position>(ball);
+  const auto* size = world.get<Size>(ball);
+  const auto* velocity = world.get<Velocity>(ball);
+  const auto* ball_data = world.get<Ball>(ball);
+  const auto* paddle_pos = world.get<Position>(paddle);
+  if (pos && size && velocity && ball_data && paddle_pos)
+  {
+    state.pos = *pos;
+    state.size = *size;
+    state.velocity = ball_data->served
+                       ? *velocity
+                       : Velocity{ ball_data->serve_x, ball_data->serve_y };
+    state.served = ball_data->served;
+    state.paddle_y = paddle_pos->y;
+  }
+  state.step_dt = step_dt;
+  state.step = step_count;
+  state.area_width = game_width;
+  return state;
+}
+
+/**
+ *   @brief   The grid the bricks are laid out on.
+ *   @details Every level brick is the same size, so a level is a grid
+ *            as regular as the arena's, only with fewer cells.
+ *   @return  The arena's grid in an arena game, or else the level's.
+ */
+BrickGrid Simulation::getBrickGrid() const
+{
+  BrickGrid grid;
+  if (arena_columns > 0)
+  {
+    grid.columns = arena.getColumns();
+    grid.rows = arena.getRows();
+    grid.cell_width = arena.getCellWidth();
+    grid.cell_height = arena.getCellHeight();
+    grid.arena = true;
+    return grid;
+  }
+
+  const auto& info = textureInfo(TextureId::BRICK_GREEN);
+  for (const auto& bricks : brick_rows)
+  {
+    grid.columns = std::max(grid.columns, static_cast<int>(bricks.size()));
+  }
+  grid.rows = static_cast<int>(brick_rows.size());
+  grid.cell_width = info.width;
+  grid.cell_height = info.height;
+  return grid;
+}
+
+/**
+ *   @brief   Whether a brick is standing in a grid cell.
+ *   @return  False outside the grid.
+ */
+bool Simulation::hasBrick(int column, int row) const
+{
+  if (arena_columns > 0)
+  {
+    return column >= 0 && row >= 0 && column < arena.getColumns() &&
+           row < arena.getRows() && arena.getHitPoints(column, row) > 0;
+  }
+  return world.isAlive(brickAt(row, column));
+}
+
+/**
+ *   @brief   Changes whenever a brick is destroyed or respawned.
+ *   @details Damage that leaves a brick standing does not count.
+ *   @return  A number that only ever goes up.
+ */
+std::uint64_t Simulation::getBrickVersion() const
+{
+  return layout_version + totals.bricks_destroyed;
+}
+
+std::uint64_t Simulation::getStepCount() const
+{
+  return step_count;
+}
+
+/**
+ *   @brief   Copies out everything needed to draw the current state.
+ *   @details Reuses the snapshot's storage, so capturing a frame does
+ *            not allocate once the snapshot has grown to size. Entities
+ *            are added a layer at a time, as archetypes are visited in
+ *            the order they were first used rather than the order the
+ *            entities should be drawn in.
+ *   @param   snapshot Overwritten with the current state.
+ *   @return  void
+ */
+void Simulation::capture(FrameSnapshot& snapshot)
+{
+  snapshot.items.clear();
+  captureArena(snapshot.items);
+
+  const auto layers = static_cast<std::size_t>(DrawLayer::COUNT);
+  for (std::size_t layer = 0; layer < layers; layer++)
+  {
+    world.each<Position, Size, Renderable>([&](Entity entity,
+                                               const Position& pos,
+                                               const Size& size,
+                                               const Renderable& r) {
+      if (static_cast<std::size_t>(r.layer) != layer)
+      {
+        return;
+      }
+
+      // the unserved ball rides on the paddle
+      const auto* ball_data = world.get<Ball>(entity);
+      DrawItem item;
+      item.texture = r.texture;
+      item.x = toFloat(pos.x);
+      item.y = toFloat(pos.y);
+      item.w = toFloat(size.w);
+      item.h = toFloat(size.h);
+      item.latched = world.get<Paddle>(entity) != nullptr ||
+                     (ball_data && !ball_data->served);
+      snapshot.items.push_back(item);
+    });
+  }
+
+  snapshot.paddle = getPaddleState();
+  snapshot.lives = getLives();
+  snapshot.score = getScore();
+  snapshot.totals = totals;
+  snapshot.entities = world.entityCount();
+  snapshot.archetypes = world.archetypeCount();
+  snapshot.stages = scheduler.stageCount();
+  snapshot.scripts = scripts.getStats();
+  snapshot.timings = scheduler.getTimings();
+}
+
+World& Simulation::getWorld()
+{
+  return world;
+}
+
+const Arena& Simulation::getArena() const
+{
+  return arena;
+}
+
+SystemScheduler& Simulation::getScheduler()
+{
+  return scheduler;
+}
+
+const ScriptScheduler& Simulation::getScripts() const
+{
+  return scripts;
+}
+
+/**
+ *   @brief   Registers the game rules with the scheduler.
+ *   @details Each system lists what it reads and writes, which lets
+ *            the scheduler run non-conflicting systems in parallel.
+ *            State held outside the world, such as the totals and the
+ *            arena, is listed as a Resource.
+ *            Movement, the paddle clamp, the ball follow and the ball
+ *            collision each use the positions the one before wrote,
+ *            so they are a chain of stages. Gem pickups only touch
+ *            their own tally, which step() adds to the score, so they
+ *            share the last stage with the ball collision.
+ *   @return  void
+ */
+void Simulation::registerSystems()
+{
+  scheduler.add("movement",
+                componentMask<Velocity>(),
+                componentMask<Position>(),
+                [this](World& w, float) {
+                  w.each<Position, Velocity>(
+                    [this](Entity, Position& pos, const Velocity& vel) {
+                      pos.x += vel.x * step_dt;
+                      pos.y += vel.y * step_dt;
+                    });
+                });
+
+  scheduler.add("paddle_clamp",
+                componentMask<Size, Paddle>(),
+                componentMask<Position>(),
+                [this](World& w, float) {
+                  w.each<Position, Size, Paddle>(
+                    [this](Entity, Position& pos, const Size& size, Paddle&) {
+                      if (pos.x <= Scalar(0))
+                      {
+                        pos.x = Scalar(0);
+                      }
+                      if (pos.x + size.w >= game_width)
+                      {
+                        pos.x = game_width - size.w;
+                      }
+                    });
+                });
+
+  scheduler.add("ball_follow",
+                componentMask<Size, Paddle, Ball>(),
+                componentMask<Position>(),
+                [this](World& w, float) {
+                  const auto* paddle_pos = w.get<Position>(paddle);
+                  const auto* paddle_size = w.get<Size>(paddle);
+                  if (!paddle_pos || !paddle_size)
+                  {
+                    return;
+                  }
+
+                  w.each<Position, Size, Ball>(
+                    [&](Entity, Position& pos, const Size& size, Ball& data) {
+                      if (!data.served)
+                      {
+                        pos.x = paddle_pos->x + paddle_size->w / Scalar(2) -
+                                size.w / Scalar(2);
+                        pos.y = paddle_pos->y - (size.h + Scalar(1));
+                      }
+                    });
+                });
+
+  scheduler.add(
+    "ball_collision",
+    componentMask<Position, Size, Paddle, Brick>(),
+    componentMask<Velocity,
+                  Ball,
+                  Session,
+                  Resource<SimulationTotals>,
+                  Resource<Arena>,
+                  Resource<ScriptScheduler>>(),
+    [this, brick_hits = std::vector<std::uint8_t>()](World& w,
+                                                     float) mutable {
+      auto* progress = w.get<Session>(session);
+      w.each<Position, Size, Velocity, Ball>([&](Entity,
+                                                 const Position& pos,
+                                                 const Size& size,
+                                                 Velocity& vel,
+                                                 Ball& data) {
+        if (!data.served)
+        {
+          return;
+        }
+
+        // BALL AND GAME BOUNDARY COLLISION
+        if (pos.x <= Scalar(0))
+        {
+          vel.x = abs(vel.x);
+        }
+        else if (pos.x + size.w >= game_width)
+        {
+          vel.x = -abs(vel.x);
+        }
+        if (pos.y <= Scalar(0))
+        {
+          vel.y = abs(vel.y);
+        }
+        if (pos.y + size.h >= game_height)
+        {
+          progress->lives -= 1;
+          totals.lives_lost++;
+          data.served = false;
+          vel = Velocity{};
+          return;
+        }
+
+        // PADDLE AND BALL COLLISION
+        w.each<Position, Size, Paddle>(
+          [&](Entity, const Position& other, const Size& other_size, Paddle&) {
+            totals.collision_tests++;
+            if (overlaps(pos, size, other, other_size))
+            {
+              vel.y = -abs(vel.y);
+            }
+          });
+
+        // BALL AND BRICKS COLLISION
+        w.eachChunk<Position, Size, Brick>([&](const Entity* bricks,
+                                               std::size_t rows,
+                                               const Position* others,
+                                               const Size* other_sizes,
+                                               const Brick* brick_data) {
+          brick_hits.resize(rows);
+          totals.collision_tests += rows;
+          if (overlapBricks(pos,
+                            size,
+                            others,
+                            other_sizes,
+                            rows,
+                            brick_hits.data()) == 0)
+          {
+            return;
+          }
+
+          for (std::size_t i = 0; i < rows; i++)
+          {
+            if (brick_hits[i] != 0)
+            {
+              vel.y = -vel.y;
+              progress->score += brick_data[i].points;
+              totals.bricks_destroyed++;
+              totals.points +=
+                static_cast<std::uint64_t>(brick_data[i].points);
+              w.destroyDeferred(bricks[i]);
+              scripts.signal(destroyedEvent(bricks[i]));
+            }
+          }
+        });
+
+        // BALL AND ARENA COLLISION
+        if (hitArena(pos, size, *progress))
+        {
+          vel.y = abs(vel.y);
+        }
+      });
+    });
+
+  scheduler.add(
+    "gem_collect",
+    componentMask<Position, Size, Paddle, Gem>(),
+    componentMask<Resource<GemPickups>>(),
+    [this](World& w, float) {
+      const auto* paddle_pos = w.get<Position>(paddle);
+      const auto* paddle_size = w.get<Size>(paddle);
+      if (!paddle_pos || !paddle_size)
+      {
+        return;
+      }
+
+      w.each<Position, Size, Gem>([&](Entity gem,
+                                      const Position& pos,
+                                      const Size& size,
+                                      const Gem& data) {
+        if (overlaps(pos, size, *paddle_pos, *paddle_size))
+        {
+          gem_pickups.points += data.points;
+          w.destroyDeferred(gem);
+        }
+        else if (pos.y >= game_height)
+        {
+          w.destroyDeferred(gem);
+        }
+      });
+    });
+}
+
+/**
+ *   @brief   Damages the arena bricks under the ball.
+ *   @details The arena is above the paddle, so a hit always sends the
+ *            ball back down. Otherwise a brick with hit points left
+ *            would catch the ball bouncing inside it.
+ *   @return  True if the ball hit any arena brick.
+ */
+bool Simulation::hitArena(const Position& pos,
+                          const Size& size,
+                          Session& progress)
+{
+  if (arena.getRemaining() == 0)
+  {
+    return false;
+  }
+
+  const auto result = arena.hit(
+    toFloat(pos.x), toFloat(pos.y), toFloat(size.w), toFloat(size.h), pool);
+  progress.score += static_cast<int>(result.destroyed);
+  totals.collision_tests += result.tested;
+  totals.bricks_destroyed += result.destroyed;
+  totals.points += result.destroyed;
+  return result.hit;
+}
+
+/**
+ *   @brief   Adds the arena bricks as runs of matching bricks.
+ *   @details A draw item per brick would mean up to a million sprites
+ *            a frame. Neighbouring bricks in a row that look the same
+ *            become one stretched item instead, so a fresh arena costs
+ *            a few items per row.
+ *   @return  void
+ */
+void Simulation::captureArena(std::vector<DrawItem>& items) const
+{
+  const auto brickLook = [this](int column, int row) {
+    switch (arena.getType(column, row))
+    {
+      case ArenaBrick::NONE:
+        return TextureId::COUNT;
+      case ArenaBrick::EXPLOSIVE:
+        return TextureId::BRICK_RED;
+      case ArenaBrick::PLAIN:
+        break;
+    }
+
+    switch (arena.getHitPoints(column, row))
+    {
+      case 1:
+        return TextureId::BRICK_GREEN;
+      case 2:
+        return TextureId::BRICK_PURPLE;
+      default:
+        return TextureId::BRICK_GREY;
+    }
+  };
+
+  const float cell_w = arena.getCellWidth();
+  const float cell_h = arena.getCellHeight();
+  for (int row = 0; row < arena.getRows() && arena.getRemaining() > 0; row++)
+  {
+    int column = 0;
+    while (column < arena.getColumns())
+    {
+      const auto texture = brickLook(column, row);
+      int end = column + 1;
+      while (end < arena.getColumns() && brickLook(end, row) == texture)
+      {
+        end++;
+      }
+
+      if (texture != TextureId::COUNT)
+      {
+        DrawItem item;
+        item.texture = texture;
+        item.x = static_cast<float>(column) * cell_w;
+        item.y = static_cast<float>(row) * cell_h;
+        item.w = static_cast<float>(end - column) * cell_w;
+        item.h = cell_h;
+        items.push_back(item);
+      }
+      column = end;
+    }
+  }
+}
+
+/**
+ *   @brief   Spawns one row of bricks from the level.
+ *   @param   row Index into the level's rows.
+ *   @return  void
+ */
+void Simulation::spawnRow(int row)
+{
+  const auto& cells = level.rows[static_cast<std::size_t>(row)];
+  auto& bricks = brick_rows[static_cast<std::size_t>(row)];
+  bricks.assign(cells.size(), Entity{});
+
+  for (std::size_t col = 0; col < cells.size(); col++)
+  {
+    TextureId texture;
+    if (!brickTexture(cells[col], texture))
+    {
+      continue;
+    }
+
+    Brick brick;
+    brick.row = row;
+    brick.column = static_cast<int>(col);
+
+    const auto& info = textureInfo(texture);
+    const Size size{ toScalar(info.width), toScalar(info.height) };
+    bricks[col] = world.create(
+      Position{ Scalar(static_cast<int>(col)) * size.w, Scalar(row) * size.h },
+      size,
+      Renderable{ texture, DrawLayer::BRICKS },
+      brick);
+  }
+}
+
+/**
+ *   @brief   Spawns the level's gems.
+ *   @details Gems are drawn as squares, the height of a brick. A gem
+ *            without a brick above it falls straight away.
+ *   @return  void
+ */
+void Simulation::spawnGems()
+{
+  const Scalar gem_size = toScalar(textureInfo(TextureId::BRICK_GREEN).height);
+  for (const auto& placement : level.gems)
+  {
+    Gem gem;
+    gem.trigger_row = placement.row;
+    gem.trigger_column = placement.column;
+    gem.trigger = brickAt(placement.row, placement.column);
+    const auto entity =
+      world.create(Position{ toScalar(placement.x), toScalar(placement.y) },
+                   Size{ gem_size, gem_size },
+                   Velocity{},
+                   Renderable{ TextureId::GEM, DrawLayer::GEMS },
+                   gem);
+    auto* data = world.get<Gem>(entity);
+    if (data != nullptr)
+    {
+      data->release_script = scripts.spawn(releaseGem(entity, gem.trigger));
+    }
+  }
+}
+
+/**
+ *   @brief   The brick spawned at a grid cell.
+ *   @return  The brick, or a handle that is never alive.
+ */
+Entity Simulation::brickAt(int row, int column) const
+{
+  if (row < 0 || column < 0 || row >= static_cast<int>(brick_rows.size()))
+  {
+    return Entity{};
+  }
+
+  const auto& bricks = brick_rows[static_cast<std::size_t>(row)];
+  if (column >= static_cast<int>(bricks.size()))
+  {
+    return Entity{};
+  }
+  return bricks[static_cast<std::size_t>(column)];
+}
+
+/**
+ *   @brief   Script that drops a gem once its trigger brick is hit.
+ *   @details Sleeps on the brick's destroyed event, so gems cost
+ *            nothing while they wait. A gem without a live trigger
+ *            falls straight away.
+ *   @param   gem The gem to release.
+ *   @param   trigger The brick the gem waits for.
+ */
+Task Simulation::releaseGem(Entity gem, Entity trigger)
+{
+  if (world.isAlive(trigger))
+  {
+    co_await scripts.waitFor(destroyedEvent(trigger));
+  }
+
+  auto* velocity = world.get<Velocity>(gem);
+  const auto* data = world.get<Gem>(gem);
+  if (velocity && data)
+  {
+    velocity->y = data->fall_speed;
+  }
+}
+
+/**
+ *   @brief   The event signalled when a brick is destroyed by the ball.
+ *   @return  The event key, unique to the brick's handle.
+ */
+std::uint64_t Simulation::destroyedEvent(Entity brick)
+{
+  return (static_cast<std::uint64_t>(brick.index) << 32) | brick.generation;
+}
+
+/**
+ *   @brief   Tests the ball against a chunk of bricks.
+ *   @details Fixed point builds compare four bricks at a time with SIMD
+ *            integer instructions. Positions and sizes are pairs of
+ *            scalars, so a column is an interleaved array of them.
+ *   @param   hits Receives 1 for each brick hit and 0 otherwise.
+ *   @return  The number of bricks hit.
+ */
+std::size_t Simulation::overlapBricks(const Position& pos,
+                                      const Size& size,
+                                      const Position* bricks,
+                                      const Size* brick_sizes,
+                                      std::size_t count,
+                                      std::uint8_t* hits)
+{
+#ifdef BREAKOUT_FIXED_POINT
+  static_assert(sizeof(Position) == 2 * sizeof(Fixed) &&
+                  sizeof(Size) == 2 * sizeof(Fixed),
+                "columns must be interleaved fixed point pairs");
+
+  const Fixed box[] = { pos.x, pos.y, size.w, size.h };
+  return overlapBatchFixed(box,
+                           reinterpret_cast<const Fixed*>(bricks),
+                           reinterpret_cast<const Fixed*>(brick_sizes),
+                           count,
+                           hits);
+#else
+  return overlapBatch(pos, size, bricks, brick_sizes, count, hits);
+#endif
+}
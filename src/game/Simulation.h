@@ -0,0 +1,137 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "Arena.h"
+#include "Components.h"
+#include "ECS.h"
+#include "FrameSnapshot.h"
+#include "Level.h"
+#include "ScriptScheduler.h"
+#include "SystemScheduler.h"
+#include "ThreadPool.h"
+
+/**
+ *  Where the ball is and how it is moving, with the walls and the
+ *  paddle line it moves between. Kept as Scalar, so the ball's path
+ *  can be worked out exactly as the simulation would step it.
+ */
+struct BallState
+{
+  Position pos;  /**< Top left of the ball. */
+  Size size;
+  Velocity velocity; /**< As if served now, if it has not been. */
+  Scalar step_dt = Scalar(0);
+  bool served = false;
+  std::uint64_t step = 0; /**< Fixed steps run so far. */
+  Scalar area_width = Scalar(0);
+  Scalar paddle_y = Scalar(0); /**< The top of the paddle. */
+};
+
+/** The grid the bricks, or the arena's bricks, are laid out on. */
+struct BrickGrid
+{
+  int columns = 0;
+  int rows = 0;
+  double cell_width = 0;
+  double cell_height = 0;
+  bool arena = false;
+};
+
+/**
+ *  The Breakout rules, expressed as systems over an entity world.
+ *  The simulation knows nothing about rendering or input devices, so
+ *  it can be stepped without a window. It always advances in fixed
+ *  steps, so the same inputs give the same game on every machine.
+ */
+class Simulation
+{
+ public:
+  enum
+  {
+    steps_per_second = 120,
+    max_steps_per_advance = 8,
+    arena_seed = 2024,
+    arena_explosive_percent = 8
+  };
+
+  Simulation();
+
+  void setArena(int columns, int rows);
+  void reset(float width,
+             float height,
+             const LevelData& layout = LevelData::defaultLevel());
+  void restart();
+  void applyLevel(const LevelData& layout, const LevelDiff& diff);
+  int advance(double seconds);
+  void step();
+
+  void setPaddleDirection(int direction);
+  void serve();
+
+  int getLives();
+  int getScore();
+  bool isWon() const;
+  bool isLost();
+
+  PaddleState getPaddleState();
+  BallState getBallState();
+  BrickGrid getBrickGrid() const;
+  bool hasBrick(int column, int row) const;
+  std::uint64_t getBrickVersion() const;
+  std::uint64_t getStepCount() const;
+  void capture(FrameSnapshot& snapshot);
+
+  World& getWorld();
+  const Arena& getArena() const;
+  SystemScheduler& getScheduler();
+  const ScriptScheduler& getScripts() const;
+
+ private:
+  /** Points from gems caught during a step, scored after it. */
+  struct GemPickups
+  {
+    int points = 0;
+  };
+
+  void registerSystems();
+  void spawnRow(int row);
+  void spawnGems();
+  Entity brickAt(int row, int column) const;
+  Task releaseGem(Entity gem, Entity trigger);
+  bool hitArena(const Position& pos, const Size& size, Session& progress);
+  void captureArena(std::vector<DrawItem>& items) const;
+
+  static std::uint64_t destroyedEvent(Entity brick);
+
+  static std::size_t overlapBricks(const Position& pos,
+                                   const Size& size,
+                                   const Position* bricks,
+                                   const Size* brick_sizes,
+                                   std::size_t count,
+                                   std::uint8_t* hits);
+
+  ThreadPool pool;
+  World world;
+  SystemScheduler scheduler;
+  ScriptScheduler scripts;
+
+  LevelData level;
+  std::vector<std::vector<Entity>> brick_rows;
+  Arena arena;
+  int arena_columns = 0; /**< Zero plays the level instead. */
+  int arena_rows = 0;
+
+  Entity session;
+  Entity paddle;
+  Entity ball;
+
+  Scalar game_width = Scalar(0);
+  Scalar game_height = Scalar(0);
+  Scalar step_dt = Scalar(1) / Scalar(steps_per_second);
+  double accumulator = 0;
+  std::uint64_t step_count = 0;
+  std::uint64_t layout_version = 0; /**< Bumped when bricks respawn. */
+  SimulationTotals totals;
+  GemPickups gem_pickups;
+};
@@ -0,0 +1,1183 @@
+#include "SoftwareRenderer.h"
+
+#include <Engine/FileIO.h>
+#include <Engine/Input.h>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
+namespace
+{
+  const double smoothing = 0.05;
+
+  /** Rows of each glyph from ' ' to '_', leftmost pixel in bit 4. */
+  const std::uint8_t font_glyphs[64][7] = {
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // ' '
+    { 0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x04 }, // '!'
+    { 0x0A, 0x0A, 0x00, 0x00, 0x00, 0x00, 0x00 }, // '"'
+    { 0x0A, 0x0A, 0x1F, 0x0A, 0x1F, 0x0A, 0x0A }, // '#'
+    { 0x04, 0x0F, 0x14, 0x0E, 0x05, 0x1E, 0x04 }, // '$'
+    { 0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03 }, // '%'
+    { 0x0C, 0x12, 0x14, 0x08, 0x15, 0x12, 0x0D }, // '&'
+    { 0x04, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00 }, // '\''
+    { 0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02 }, // '('
+    { 0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08 }, // ')'
+    { 0x00, 0x04, 0x15, 0x0E, 0x15, 0x04, 0x00 }, // '*'
+    { 0x00, 0x04, 0x04, 0x1F, 0x04, 0x04, 0x00 }, // '+'
+    { 0x00, 0x00, 0x00, 0x00, 0x06, 0x04, 0x08 }, // ','
+    { 0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00 }, // '-'
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C }, // '.'
+    { 0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00 }, // '/'
+    { 0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E }, // '0'
+    { 0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E }, // '1'
+    { 0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F }, // '2'
+    { 0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E }, // '3'
+    { 0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02 }, // '4'
+    { 0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E }, // '5'
+    { 0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E }, // '6'
+    { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08 }, // '7'
+    { 0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E }, // '8'
+    { 0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C }, // '9'
+    { 0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00 }, // ':'
+    { 0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x04, 0x08 }, // ';'
+    { 0x02, 0x04, 0x08, 0x10, 0x08, 0x04, 0x02 }, // '<'
+    { 0x00, 0x00, 0x1F, 0x00, 0x1F, 0x00, 0x00 }, // '='
+    { 0x08, 0x04, 0x02, 0x01, 0x02, 0x04, 0x08 }, // '>'
+    { 0x0E, 0x11, 0x01, 0x02, 0x04, 0x00, 0x04 }, // '?'
+    { 0x0E, 0x11, 0x01, 0x0D, 0x15, 0x15, 0x0E }, // '@'
+    { 0x0E, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 }, // 'A'
+    { 0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E }, // 'B'
+    { 0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E }, // 'C'
+    { 0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C }, // 'D'
+    { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F }, // 'E'
+    { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10 }, // 'F'
+    { 0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F }, // 'G'
+    { 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 }, // 'H'
+    { 0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E }, // 'I'
+    { 0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C }, // 'J'
+    { 0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11 }, // 'K'
+    { 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F }, // 'L'
+    { 0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11 }, // 'M'
+    { 0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11 }, // 'N'
+    { 0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E }, // 'O'
+    { 0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10 }, // 'P'
+    { 0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D }, // 'Q'
+    { 0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11 }, // 'R'
+    { 0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E }, // 'S'
+    { 0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04 }, // 'T'
+    { 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E }, // 'U'
+    { 0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04 }, // 'V'
+    { 0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A }, // 'W'
+    { 0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11 }, // 'X'
+    { 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04, 0x04 }, // 'Y'
+    { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F }, // 'Z'
+    { 0x0E, 0x08, 0x08, 0x08, 0x08, 0x08, 0x0E }, // '['
+    { 0x00, 0x10, 0x08, 0x04, 0x02, 0x01, 0x00 }, // '\\'
+    { 0x0E, 0x02, 0x02, 0x02, 0x02, 0x02, 0x0E }, // ']'
+    { 0x04, 0x0A, 0x11, 0x00, 0x00, 0x00, 0x00 }, // '^'
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F }, // '_'
+  };
+
+  std::uint32_t packColour(const ASGE::Colour& colour)
+  {
+    const auto channel = [](float value) {
+      return static_cast<std::uint32_t>(
+        std::lround(std::clamp(value, 0.0F, 1.0F) * 255.0F));
+    };
+    return channel(colour.r) | (channel(colour.g) << 8) |
+           (channel(colour.b) << 16) | 0xFF000000U;
+  }
+
+  /**
+   *   @brief   Decodes an uncompressed 24 or 32 bit TGA.
+   *   @param   data The file contents.
+   *   @param   size The length of the file.
+   *   @param   rgba Receives the pixels, top row first, as RGBA bytes.
+   *   @return  False if the file is not a TGA this can read.
+   */
+  bool decodeTga(const std::uint8_t* data,
+                 std::size_t size,
+                 int& width,
+                 int& height,
+                 std::vector<std::uint8_t>& rgba)
+  {
+    if (size < 18 || data[1] != 0 || data[2] != 2 ||
+        (data[16] != 24 && data[16] != 32))
+    {
+      return false;
+    }
+
+    width = data[12] | (data[13] << 8);
+    height = data[14] | (data[15] << 8);
+    const std::size_t bytes_per_pixel = data[16] / 8U;
+    const bool top_first = (data[17] & 0x20) != 0;
+    const std::size_t offset = 18U + data[0];
+    const auto pixels =
+      static_cast<std::size_t>(width) * static_cast<std::size_t>(height);
+    if (width == 0 || height == 0 || offset + pixels * bytes_per_pixel > size)
+    {
+      return false;
+    }
+
+    rgba.resize(pixels * 4);
+    for (std::size_t i = 0; i < pixels; i++)
+    {
+      const auto row = i / static_cast<std::size_t>(width);
+      const auto column = i % static_cast<std::size_t>(width);
+      const auto source_row =
+        top_first ? row : static_cast<std::size_t>(height) - 1 - row;
+      const auto* pixel =
+        data + offset +
+        (source_row * static_cast<std::size_t>(width) + column) *
+          bytes_per_pixel;
+
+      rgba[i * 4] = pixel[2];
+      rgba[i * 4 + 1] = pixel[1];
+      rgba[i * 4 + 2] = pixel[0];
+      rgba[i * 4 + 3] = bytes_per_pixel == 4 ? pixel[3] : 0xFF;
+    }
+    return true;
+  }
+
+  std::uint32_t crc32(const std::uint8_t* data,
+                      std::size_t size,
+                      std::uint32_t crc = 0)
+  {
+    static const auto table = [] {
+      std::array<std::uint32_t, 256> entries{};
+      for (std::uint32_t i = 0; i < 256; i++)
+      {
+        std::uint32_t value = i;
+        for (int bit = 0; bit < 8; bit++)
+        {
+          value = (value & 1) ? 0xEDB88320U ^ (value >> 1) : value >> 1;
+        }
+        entries[i] = value;
+      }
+      return entries;
+    }();
+
+    crc = ~crc;
+    for (std::size_t i = 0; i < size; i++)
+    {
+      crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+  }
+
+  void appendBigEndian(std::vector<std::uint8_t>& out, std::uint32_t value)
+  {
+    for (int shift = 24; shift >= 0; shift -= 8)
+    {
+      out.push_back(static_cast<std::uint8_t>(value >> shift));
+    }
+  }
+
+  void appendChunk(std::vector<std::uint8_t>& out,
+                   const char* type,
+                   const std::vector<std::uint8_t>& data)
+  {
+    appendBigEndian(out, static_cast<std::uint32_t>(data.size()));
+    const auto start = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data.begin(), data.end());
+    appendBigEndian(out, crc32(out.data() + start, out.size() - start));
+  }
+
+  /**
+   *   @brief   Wraps data in a zlib stream of stored deflate blocks.
+   *   @details Nothing is compressed, which keeps writing a frame cheap
+   *            and needs no zlib. Captures are for checking, not keeping.
+   *   @return  The zlib stream.
+   */
+  std::vector<std::uint8_t> storeZlib(const std::vector<std::uint8_t>& data)
+  {
+    enum
+    {
+      max_block = 65535
+    };
+
+    std::vector<std::uint8_t> out{ 0x78, 0x01 };
+    std::uint32_t adler_low = 1;
+    std::uint32_t adler_high = 0;
+    std::size_t offset = 0;
+    do
+    {
+      const auto length =
+        std::min<std::size_t>(data.size() - offset, max_block);
+      const bool last = offset + length == data.size();
+      out.push_back(last ? 1 : 0);
+      out.push_back(static_cast<std::uint8_t>(length & 0xFF));
+      out.push_back(static_cast<std::uint8_t>(length >> 8));
+      out.push_back(static_cast<std::uint8_t>(~length & 0xFF));
+      out.push_back(static_cast<std::uint8_t>((~length >> 8) & 0xFF));
+      out.insert(out.end(),
+                 data.begin() + static_cast<std::ptrdiff_t>(offset),
+                 data.begin() + static_cast<std::ptrdiff_t>(offset + length));
+
+      for (std::size_t i = offset; i < offset + length; i++)
+      {
+        adler_low = (adler_low + data[i]) % 65521U;
+        adler_high = (adler_high + adler_low) % 65521U;
+      }
+      offset += length;
+    } while (offset < data.size());
+
+    appendBigEndian(out, (adler_high << 16) | adler_low);
+    return out;
+  }
+
+  /**
+   *   @brief   Blends a span of texels over the framebuffer.
+   *   @details Texels are premultiplied, so each channel becomes
+   *            src * tint + dst * (1 - src alpha), all in 8.8 fixed
+   *            point. The SSE2 path blends four pixels at once with the
+   *            same integer maths, so both paths give the same pixels.
+   *   @param   target The first framebuffer pixel of the span.
+   *   @param   source The texture row being sampled.
+   *   @param   columns The texel column for each pixel of the span.
+   *   @param   contiguous Whether the columns run up by one, as they do
+   *            for a texture drawn at its own size.
+   *   @param   count The number of pixels in the span.
+   *   @param   tint The premultiplied RGBA tint.
+   *   @return  void
+   */
+  void blendSpan(std::uint32_t* target,
+                 const std::uint32_t* source,
+                 const int* columns,
+                 bool contiguous,
+                 int count,
+                 const std::uint16_t tint[4])
+  {
+    int i = 0;
+
+#ifdef __SSE2__
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i full = _mm_set1_epi16(256);
+    const auto t0 = static_cast<short>(tint[0]);
+    const auto t1 = static_cast<short>(tint[1]);
+    const auto t2 = static_cast<short>(tint[2]);
+    const auto t3 = static_cast<short>(tint[3]);
+    const __m128i tint_lanes = _mm_set_epi16(t3, t2, t1, t0, t3, t2, t1, t0);
+
+    const auto blendHalf = [&](__m128i texels, __m128i pixels) {
+      texels = _mm_srli_epi16(_mm_mullo_epi16(texels, tint_lanes), 8);
+      const __m128i alpha = _mm_shufflehi_epi16(
+        _mm_shufflelo_epi16(texels, _MM_SHUFFLE(3, 3, 3, 3)),
+        _MM_SHUFFLE(3, 3, 3, 3));
+      pixels = _mm_srli_epi16(
+        _mm_mullo_epi16(pixels, _mm_sub_epi16(full, alpha)), 8);
+      return _mm_add_epi16(texels, pixels);
+    };
+
+    for (; i + 4 <= count; i += 4)
+    {
+      const __m128i texels =
+        contiguous
+          ? _mm_loadu_si128(
+              reinterpret_cast<const __m128i*>(source + columns[i]))
+          : _mm_set_epi32(static_cast<int>(source[columns[i + 3]]),
+                          static_cast<int>(source[columns[i + 2]]),
+                          static_cast<int>(source[columns[i + 1]]),
+                          static_cast<int>(source[columns[i]]));
+      auto* pixel = reinterpret_cast<__m128i*>(target + i);
+      const __m128i pixels = _mm_loadu_si128(pixel);
+
+      const __m128i low = blendHalf(_mm_unpacklo_epi8(texels, zero),
+                                    _mm_unpacklo_epi8(pixels, zero));
+      const __m128i high = blendHalf(_mm_unpackhi_epi8(texels, zero),
+                                     _mm_unpackhi_epi8(pixels, zero));
+      _mm_storeu_si128(pixel, _mm_packus_epi16(low, high));
+    }
+#else
+    (void)contiguous;
+#endif
+
+    for (; i < count; i++)
+    {
+      const std::uint32_t texel = source[columns[i]];
+      std::uint32_t channels[4];
+      for (int c = 0; c < 4; c++)
+      {
+        channels[c] = (((texel >> (8 * c)) & 0xFF) * tint[c]) >> 8;
+      }
+
+      const std::uint32_t pixel = target[i];
+      const std::uint32_t inverse = 256 - channels[3];
+      std::uint32_t result = 0;
+      for (int c = 0; c < 4; c++)
+      {
+        const std::uint32_t value =
+          channels[c] + ((((pixel >> (8 * c)) & 0xFF) * inverse) >> 8);
+        result |= std::min(value, 255U) << (8 * c);
+      }
+      target[i] = result;
+    }
+  }
+}
+
+/**
+ *   @brief   Constructor.
+ *   @param   width The width in texels.
+ *   @param   height The height in texels.
+ */
+SoftwareTexture::SoftwareTexture(int width, int height) :
+  ASGE::Texture2D(width, height),
+  pixels(static_cast<std::size_t>(width) * static_cast<std::size_t>(height))
+{
+  format = RGBA;
+}
+
+/**
+ *   @brief   Replaces the texels.
+ *   @param   data RGBA bytes with straight alpha, top row first. They
+ *            are premultiplied as they are copied.
+ *   @return  void
+ */
+void SoftwareTexture::setData(void* data)
+{
+  const auto* bytes = static_cast<const std::uint8_t*>(data);
+  for (std::size_t i = 0; i < pixels.size(); i++)
+  {
+    const std::uint32_t alpha = bytes[i * 4 + 3];
+    std::uint32_t texel = alpha << 24;
+    for (std::size_t c = 0; c < 3; c++)
+    {
+      texel |= ((bytes[i * 4 + c] * alpha + 127) / 255) << (8 * c);
+    }
+    pixels[i] = texel;
+  }
+}
+
+/**
+ *   @brief   The premultiplied texels.
+ *   @return  One RGBA word per texel, top row first.
+ */
+void* SoftwareTexture::getData()
+{
+  return pixels.data();
+}
+
+const std::uint32_t* SoftwareTexture::getPixels() const
+{
+  return pixels.data();
+}
+
+SoftwareSprite::SoftwareSprite(SoftwareRenderer& owner) : renderer(owner) {}
+
+/**
+ *   @brief   Loads the sprite's texture through the renderer's cache.
+ *   @details The sprite is sized to the whole texture.
+ *   @param   file The texture's path in the virtual file system.
+ *   @return  False if the texture could not be read.
+ */
+bool SoftwareSprite::loadTexture(const std::string& file)
+{
+  auto loaded = renderer.loadTexture(file);
+  if (!loaded)
+  {
+    return false;
+  }
+
+  texture = std::move(loaded);
+  dims[0] = static_cast<float>(texture->getWidth());
+  dims[1] = static_cast<float>(texture->getHeight());
+  src_rect[0] = 0;
+  src_rect[1] = 0;
+  src_rect[2] = dims[0];
+  src_rect[3] = dims[1];
+  return true;
+}
+
+const ASGE::Texture2D* SoftwareSprite::getTexture() const
+{
+  return texture.get();
+}
+
+/**
+ *   @brief   Constructor.
+ *   @details ASGE has no library value for a software renderer, so it
+ *            reports itself as INVALID.
+ *   @param   threads The number of threads that draw tiles.
+ */
+SoftwareRenderer::SoftwareRenderer(unsigned int threads) :
+  ASGE::Renderer(RenderLib::INVALID), pool(std::max(threads, 1U))
+{
+  font.font_name = "5x7";
+  font.font_size = glyph_rows * text_pixel_scale;
+  font.line_height = glyph_line * text_pixel_scale;
+}
+
+SoftwareRenderer::~SoftwareRenderer() = default;
+
+/**
+ *   @brief   Allocates the framebuffer.
+ *   @param   w The width in pixels.
+ *   @param   h The height in pixels.
+ *   @param   mode Recorded only, as there is no window.
+ *   @return  False if the size is empty.
+ */
+bool SoftwareRenderer::init(int w, int h, ASGE::Renderer::WindowMode mode)
+{
+  if (w <= 0 || h <= 0)
+  {
+    return false;
+  }
+
+  width = w;
+  height = h;
+  window_mode = mode;
+  framebuffer.assign(
+    static_cast<std::size_t>(width) * static_cast<std::size_t>(height),
+    packColour(cls));
+  resizeTarget();
+  return true;
+}
+
+bool SoftwareRenderer::exit()
+{
+  framebuffer.clear();
+  scaled.clear();
+  tile_blits.clear();
+  blits.clear();
+  width = 0;
+  height = 0;
+  render_width = 0;
+  render_height = 0;
+  target = nullptr;
+  return true;
+}
+
+/**
+ *   @brief   Starts a frame.
+ *   @return  void
+ */
+void SoftwareRenderer::preRender()
+{
+  blits.clear();
+}
+
+/**
+ *   @brief   Draws everything queued since preRender().
+ *   @return  void
+ */
+void SoftwareRenderer::postRender()
+{
+  rasterise();
+}
+
+void SoftwareRenderer::swapBuffers() {}
+
+void SoftwareRenderer::setClearColour(ASGE::Colour rgb)
+{
+  cls = rgb;
+}
+
+void SoftwareRenderer::setDefaultTextColour(const ASGE::Colour& colour)
+{
+  default_text_colour = colour;
+}
+
+/**
+ *   @brief   Ignored; sprites are always drawn in the order rendered.
+ *   @return  void
+ */
+void SoftwareRenderer::setSpriteMode(ASGE::SpriteSortMode) {}
+
+void SoftwareRenderer::setWindowedMode(ASGE::Renderer::WindowMode mode)
+{
+  window_mode = mode;
+}
+
+void SoftwareRenderer::setWindowTitle(const char*) {}
+
+/**
+ *   @brief   Font files are not supported.
+ *   @return  -1, as only the built in font can be used.
+ */
+int SoftwareRenderer::loadFont(const char*, int)
+{
+  return -1;
+}
+
+/**
+ *   @brief   Font files are not supported.
+ *   @return  -1, as only the built in font can be used.
+ */
+int SoftwareRenderer::loadFontFromMem(const char*,
+                                      const unsigned char*,
+                                      unsigned int,
+                                      int)
+{
+  return -1;
+}
+
+const ASGE::Font& SoftwareRenderer::getActiveFont() const
+{
+  return font;
+}
+
+void SoftwareRenderer::setFont(int) {}
+
+/**
+ *   @brief   Queues a line of text in the built in font.
+ *   @details Lower case letters are drawn as capitals and characters
+ *            the font lacks as '?'.
+ *   @param   str The text. Newlines start a new line.
+ *   @param   x The left of the text in pixels.
+ *   @param   y The baseline of the first line in pixels.
+ *   @param   scale Multiplies the font's size, rounded to whole pixels.
+ *   @param   colour The colour of the text.
+ *   @return  void
+ */
+void SoftwareRenderer::renderText(std::string str,
+                                  int x,
+                                  int y,
+                                  float scale,
+                                  const ASGE::Colour& colour,
+                                  float)
+{
+  const int pixel_scale = std::max(
+    static_cast<int>(
+      std::lround(scale * static_cast<float>(text_pixel_scale))),
+    1);
+  const float source[4] = { 0,
+                            0,
+                            static_cast<float>(glyph_columns * pixel_scale),
+                            static_cast<float>(glyph_rows * pixel_scale) };
+
+  int pen_x = x;
+  int baseline = y;
+  for (const char character : str)
+  {
+    if (character == '\n')
+    {
+      pen_x = x;
+      baseline += glyph_line * pixel_scale;
+      continue;
+    }
+
+    if (character != ' ')
+    {
+      queueBlit(glyph(character, pixel_scale),
+                source,
+                static_cast<float>(pen_x),
+                static_cast<float>(baseline) - source[3],
+                source[2],
+                source[3],
+                false,
+                false,
+                colour,
+                1.0F);
+    }
+    pen_x += glyph_advance * pixel_scale;
+  }
+}
+
+/**
+ *   @brief   Queues a sprite.
+ *   @details Sprites from other renderers, or without a texture, are
+ *            skipped.
+ *   @return  void
+ */
+void SoftwareRenderer::renderSprite(const ASGE::Sprite& sprite, float)
+{
+  const auto* texture =
+    dynamic_cast<const SoftwareTexture*>(sprite.getTexture());
+  if (!texture)
+  {
+    return;
+  }
+
+  queueBlit(*texture,
+            sprite.srcRect(),
+            sprite.xPos(),
+            sprite.yPos(),
+            sprite.width() * sprite.scale(),
+            sprite.height() * sprite.scale(),
+            sprite.isFlippedOnX(),
+            sprite.isFlippedOnY(),
+            sprite.colour(),
+            sprite.opacity());
+}
+
+/**
+ *   @brief   There is no window to read input from.
+ *   @return  nullptr
+ */
+std::unique_ptr<ASGE::Input> SoftwareRenderer::inputPtr()
+{
+  return nullptr;
+}
+
+std::unique_ptr<ASGE::Sprite> SoftwareRenderer::createUniqueSprite()
+{
+  return std::make_unique<SoftwareSprite>(*this);
+}
+
+ASGE::Sprite* SoftwareRenderer::createRawSprite()
+{
+  return new SoftwareSprite(*this);
+}
+
+/**
+ *   @brief   Shaders are not supported.
+ *   @return  -1
+ */
+int SoftwareRenderer::initPixelShader(std::string)
+{
+  return -1;
+}
+
+ASGE::SHADER_LIB::Shader* SoftwareRenderer::findShader(int)
+{
+  return nullptr;
+}
+
+void SoftwareRenderer::setActiveShader(ASGE::SHADER_LIB::Shader*) {}
+
+/**
+ *   @brief   Reads a texture, or returns it from the cache.
+ *   @details Textures are cached by path, as ASGE does.
+ *   @param   file The texture's path in the virtual file system. Only
+ *            uncompressed TGA files can be read.
+ *   @return  The texture, or nullptr if it could not be read.
+ */
+std::shared_ptr<SoftwareTexture>
+SoftwareRenderer::loadTexture(const std::string& file)
+{
+  const auto cached = textures.find(file);
+  if (cached != textures.end())
+  {
+    return cached->second;
+  }
+
+  ASGE::FILEIO::File handle;
+  if (!handle.open(file))
+  {
+    return nullptr;
+  }
+  auto buffer = handle.read();
+
+  int texture_width = 0;
+  int texture_height = 0;
+  std::vector<std::uint8_t> rgba;
+  if (!decodeTga(reinterpret_cast<const std::uint8_t*>(buffer.as_char()),
+                 buffer.length,
+                 texture_width,
+                 texture_height,
+                 rgba))
+  {
+    return nullptr;
+  }
+
+  auto texture =
+    std::make_shared<SoftwareTexture>(texture_width, texture_height);
+  texture->setData(rgba.data());
+  textures[file] = texture;
+  return texture;
+}
+
+/**
+ *   @brief   Drops a texture from the cache.
+ *   @details Sprites still drawing it keep it alive until they go.
+ *   @param   file The path the texture was loaded from.
+ *   @return  void
+ */
+void SoftwareRenderer::releaseTexture(const std::string& file)
+{
+  textures.erase(file);
+}
+
+/**
+ *   @brief   Caches texels as if they had been loaded from a file.
+ *   @details Lets textures made in memory be drawn with a sprite, by
+ *            loading the sprite from the same path.
+ *   @param   rgba RGBA bytes with straight alpha, top row first.
+ *   @return  void
+ */
+void SoftwareRenderer::addTexture(const std::string& file,
+                                  int texture_width,
+                                  int texture_height,
+                                  const std::uint8_t* rgba)
+{
+  auto texture =
+    std::make_shared<SoftwareTexture>(texture_width, texture_height);
+  texture->setData(const_cast<std::uint8_t*>(rgba));
+  textures[file] = std::move(texture);
+}
+
+/**
+ *   @brief   Sets the fraction of the framebuffer's size drawn at.
+ *   @details Takes effect from the next frame. Sprites and text are
+ *            still placed in framebuffer pixels.
+ *   @param   scale Clamped to between 0.1 and 1.
+ *   @return  void
+ */
+void SoftwareRenderer::setRenderScale(float scale)
+{
+  const float clamped = std::clamp(scale, 0.1F, 1.0F);
+  if (clamped != render_scale)
+  {
+    render_scale = clamped;
+    resizeTarget();
+  }
+}
+
+float SoftwareRenderer::getRenderScale() const
+{
+  return render_scale;
+}
+
+int SoftwareRenderer::getWidth() const
+{
+  return width;
+}
+
+int SoftwareRenderer::getHeight() const
+{
+  return height;
+}
+
+int SoftwareRenderer::getRenderWidth() const
+{
+  return render_width;
+}
+
+int SoftwareRenderer::getRenderHeight() const
+{
+  return render_height;
+}
+
+/**
+ *   @brief   The last frame drawn.
+ *   @return  One RGBA word per pixel, top row first.
+ */
+const std::vector<std::uint32_t>& SoftwareRenderer::getPixels() const
+{
+  return framebuffer;
+}
+
+/**
+ *   @brief   Writes the last frame drawn as an RGB PNG.
+ *   @param   path A path on the real file system.
+ *   @return  False if the file could not be written.
+ */
+bool SoftwareRenderer::writePng(const std::string& path) const
+{
+  if (framebuffer.empty())
+  {
+    return false;
+  }
+
+  const auto row_bytes = static_cast<std::size_t>(width) * 3 + 1;
+  std::vector<std::uint8_t> rows(row_bytes * static_cast<std::size_t>(height));
+  for (std::size_t y = 0; y < static_cast<std::size_t>(height); y++)
+  {
+    auto* row = rows.data() + y * row_bytes;
+    row[0] = 0; // no filter
+    for (std::size_t x = 0; x < static_cast<std::size_t>(width); x++)
+    {
+      const auto pixel = framebuffer[y * static_cast<std::size_t>(width) + x];
+      row[1 + x * 3] = static_cast<std::uint8_t>(pixel);
+      row[2 + x * 3] = static_cast<std::uint8_t>(pixel >> 8);
+      row[3 + x * 3] = static_cast<std::uint8_t>(pixel >> 16);
+    }
+  }
+
+  std::vector<std::uint8_t> header;
+  appendBigEndian(header, static_cast<std::uint32_t>(width));
+  appendBigEndian(header, static_cast<std::uint32_t>(height));
+  header.insert(header.end(), { 8, 2, 0, 0, 0 }); // 8 bit RGB
+
+  std::vector<std::uint8_t> png{ 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+  appendChunk(png, "IHDR", header);
+  appendChunk(png, "IDAT", storeZlib(rows));
+  appendChunk(png, "IEND", {});
+
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  out.write(reinterpret_cast<const char*>(png.data()),
+            static_cast<std::streamsize>(png.size()));
+  return static_cast<bool>(out);
+}
+
+/**
+ *   @brief   Hashes the last frame drawn.
+ *   @details Used to check that frames match for any thread count.
+ *   @return  A 64 bit FNV-1a hash.
+ */
+std::uint64_t SoftwareRenderer::hash() const
+{
+  std::uint64_t value = 14695981039346656037ULL;
+  for (const auto pixel : framebuffer)
+  {
+    value ^= pixel;
+    value *= 1099511628211ULL;
+  }
+  return value;
+}
+
+SoftwareRenderer::Stats SoftwareRenderer::getStats() const
+{
+  return stats;
+}
+
+/**
+ *   @brief   Queues a texture drawn to a rectangle.
+ *   @details A pixel is covered when its centre is inside the
+ *            rectangle, and samples the nearest texel to its centre.
+ *   @param   source The texels to draw: x, y, width and height.
+ *   @param   colour Tints the texture.
+ *   @param   opacity Multiplies the texture's alpha.
+ *   @return  void
+ */
+void SoftwareRenderer::queueBlit(const SoftwareTexture& texture,
+                                 const float source[4],
+                                 float x,
+                                 float y,
+                                 float w,
+                                 float h,
+                                 bool flip_x,
+                                 bool flip_y,
+                                 const ASGE::Colour& colour,
+                                 float opacity)
+{
+  if (w <= 0 || h <= 0 || opacity <= 0)
+  {
+    return;
+  }
+
+  const auto firstPixel = [](float edge, int limit) {
+    return std::clamp(
+      static_cast<int>(std::ceil(edge - 0.5F)), 0, limit);
+  };
+
+  // from framebuffer pixels to the pixels drawn at the render scale
+  if (render_width != width || render_height != height)
+  {
+    const float scale_x =
+      static_cast<float>(render_width) / static_cast<float>(width);
+    const float scale_y =
+      static_cast<float>(render_height) / static_cast<float>(height);
+    x *= scale_x;
+    w *= scale_x;
+    y *= scale_y;
+    h *= scale_y;
+  }
+
+  Blit blit;
+  blit.texture = &texture;
+  blit.left = firstPixel(x, render_width);
+  blit.right = firstPixel(x + w, render_width);
+  blit.top = firstPixel(y, render_height);
+  blit.bottom = firstPixel(y + h, render_height);
+  if (blit.left >= blit.right || blit.top >= blit.bottom)
+  {
+    return;
+  }
+
+  // texel coordinates at the centre of the first pixel, in 16.16
+  const auto toFixed = [](double value) {
+    return static_cast<std::int64_t>(std::llround(value * 65536.0));
+  };
+  const double step_x = static_cast<double>(source[2]) / w;
+  const double step_y = static_cast<double>(source[3]) / h;
+  const double offset_x = (blit.left + 0.5 - static_cast<double>(x)) * step_x;
+  const double offset_y = (blit.top + 0.5 - static_cast<double>(y)) * step_y;
+  blit.u = toFixed(flip_x ? source[0] + source[2] - offset_x
+                          : source[0] + offset_x);
+  blit.v = toFixed(flip_y ? source[1] + source[3] - offset_y
+                          : source[1] + offset_y);
+  blit.du = toFixed(flip_x ? -step_x : step_x);
+  blit.dv = toFixed(flip_y ? -step_y : step_y);
+
+  const auto toTint = [](float value) {
+    return static_cast<std::uint16_t>(
+      std::lround(std::clamp(value, 0.0F, 1.0F) * 256.0F));
+  };
+  const float alpha = std::min(opacity, 1.0F);
+  blit.tint[0] = toTint(colour.r * alpha);
+  blit.tint[1] = toTint(colour.g * alpha);
+  blit.tint[2] = toTint(colour.b * alpha);
+  blit.tint[3] = toTint(alpha);
+
+  blits.push_back(blit);
+}
+
+/**
+ *   @brief   A glyph of the built in font, rasterised at a size.
+ *   @details Built the first time each character is drawn at each size
+ *            and cached for the life of the renderer. Glyphs are white
+ *            and tinted as they are drawn.
+ *   @return  The glyph's texture.
+ */
+const SoftwareTexture& SoftwareRenderer::glyph(char character, int pixel_scale)
+{
+  if (character >= 'a' && character <= 'z')
+  {
+    character = static_cast<char>(character - 'a' + 'A');
+  }
+  if (character < ' ' || character > '_')
+  {
+    character = '?';
+  }
+
+  const auto code = static_cast<std::uint32_t>(character - ' ');
+  const auto key = (static_cast<std::uint32_t>(pixel_scale) << 8) | code;
+  auto& cached = glyphs[key];
+  if (cached)
+  {
+    return *cached;
+  }
+
+  const int glyph_width = glyph_columns * pixel_scale;
+  const int glyph_height = glyph_rows * pixel_scale;
+  std::vector<std::uint8_t> rgba(
+    static_cast<std::size_t>(glyph_width * glyph_height) * 4);
+  for (int y = 0; y < glyph_height; y++)
+  {
+    const auto bits = font_glyphs[code][y / pixel_scale];
+    for (int x = 0; x < glyph_width; x++)
+    {
+      const int column = x / pixel_scale;
+      const bool set = ((bits >> (glyph_columns - 1 - column)) & 1) != 0;
+      const auto texel = static_cast<std::size_t>(y * glyph_width + x) * 4;
+      std::fill_n(rgba.begin() + static_cast<std::ptrdiff_t>(texel),
+                  4,
+                  set ? 0xFF : 0x00);
+    }
+  }
+
+  cached = std::make_unique<SoftwareTexture>(glyph_width, glyph_height);
+  cached->setData(rgba.data());
+  stats.cached_glyphs = glyphs.size();
+  return *cached;
+}
+
+/**
+ *   @brief   Sizes the buffer the tiles are drawn into.
+ *   @details At a render scale of 1 the tiles are drawn straight into
+ *            the framebuffer. Below it they are drawn into a smaller
+ *            buffer, which upscale() stretches over the framebuffer.
+ *   @return  void
+ */
+void SoftwareRenderer::resizeTarget()
+{
+  if (framebuffer.empty())
+  {
+    return;
+  }
+
+  const auto scaledSize = [this](int size) {
+    return std::max(
+      static_cast<int>(std::lround(static_cast<float>(size) * render_scale)),
+      1);
+  };
+  render_width = scaledSize(width);
+  render_height = scaledSize(height);
+
+  if (render_width == width && render_height == height)
+  {
+    scaled.clear();
+    target = framebuffer.data();
+  }
+  else
+  {
+    scaled.assign(static_cast<std::size_t>(render_width) *
+                    static_cast<std::size_t>(render_height),
+                  packColour(cls));
+    target = scaled.data();
+  }
+
+  // the render pixel nearest each framebuffer pixel's centre
+  upscale_columns.resize(static_cast<std::size_t>(width));
+  for (int x = 0; x < width; x++)
+  {
+    upscale_columns[static_cast<std::size_t>(x)] =
+      ((2 * x + 1) * render_width) / (2 * width);
+  }
+
+  tile_columns = (render_width + tile_size - 1) / tile_size;
+  tile_rows = (render_height + tile_size - 1) / tile_size;
+  tile_blits.assign(static_cast<std::size_t>(tile_columns * tile_rows), {});
+}
+
+/**
+ *   @brief   Bins the queued draws into tiles and draws every tile.
+ *   @details Each row of tiles is a job. A draw is only listed in the
+ *            tiles it covers, so each tile skips everything that does
+ *            not touch it.
+ *   @return  void
+ */
+void SoftwareRenderer::rasterise()
+{
+  if (framebuffer.empty())
+  {
+    return;
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  for (auto& list : tile_blits)
+  {
+    list.clear();
+  }
+
+  std::size_t binned = 0;
+  for (std::size_t i = 0; i < blits.size(); i++)
+  {
+    const auto& blit = blits[i];
+    for (int row = blit.top / tile_size; row <= (blit.bottom - 1) / tile_size;
+         row++)
+    {
+      for (int column = blit.left / tile_size;
+           column <= (blit.right - 1) / tile_size;
+           column++)
+      {
+        tile_blits[static_cast<std::size_t>(row * tile_columns + column)]
+          .push_back(static_cast<std::uint32_t>(i));
+        binned++;
+      }
+    }
+  }
+
+  jobs.clear();
+  for (int row = 0; row < tile_rows; row++)
+  {
+    jobs.emplace_back([this, row] {
+      for (int column = 0; column < tile_columns; column++)
+      {
+        drawTile(column, row);
+      }
+    });
+  }
+  pool.run(jobs);
+  upscale();
+
+  const std::chrono::duration<double, std::milli> elapsed =
+    std::chrono::steady_clock::now() - start;
+  stats.draws = blits.size();
+  stats.binned = binned;
+  stats.last_raster_ms = elapsed.count();
+  stats.raster_ms += (elapsed.count() - stats.raster_ms) * smoothing;
+}
+
+/**
+ *   @brief   Clears a tile and draws its list in order.
+ *   @return  void
+ */
+void SoftwareRenderer::drawTile(int column, int row)
+{
+  const int left = column * tile_size;
+  const int top = row * tile_size;
+  const int right = std::min(left + tile_size, render_width);
+  const int bottom = std::min(top + tile_size, render_height);
+
+  const auto clear = packColour(cls);
+  for (int y = top; y < bottom; y++)
+  {
+    auto* line = target + static_cast<std::size_t>(y) *
+                            static_cast<std::size_t>(render_width);
+    std::fill(line + left, line + right, clear);
+  }
+
+  for (const auto index : tile_blits[static_cast<std::size_t>(
+         row * tile_columns + column)])
+  {
+    const auto& blit = blits[index];
+    drawBlit(blit,
+             std::max(blit.left, left),
+             std::max(blit.top, top),
+             std::min(blit.right, right),
+             std::min(blit.bottom, bottom));
+  }
+}
+
+/**
+ *   @brief   Draws the part of a blit inside a tile.
+ *   @details The texel columns are worked out once and shared by
+ *            every row.
+ *   @return  void
+ */
+void SoftwareRenderer::drawBlit(const Blit& blit,
+                                int left,
+                                int top,
+                                int right,
+                                int bottom)
+{
+  const auto& texture = *blit.texture;
+  const auto texture_width = static_cast<int>(texture.getWidth());
+  const auto texture_height = static_cast<int>(texture.getHeight());
+  const auto texelAt = [](std::int64_t fixed, int limit) {
+    return static_cast<int>(
+      std::clamp<std::int64_t>(fixed >> 16, 0, limit - 1));
+  };
+
+  int columns[tile_size];
+  const int count = right - left;
+  for (int i = 0; i < count; i++)
+  {
+    columns[i] =
+      texelAt(blit.u + (left - blit.left + i) * blit.du, texture_width);
+  }
+  const bool contiguous = blit.du == 65536 && count > 0 &&
+                          columns[count - 1] - columns[0] == count - 1;
+
+  for (int y = top; y < bottom; y++)
+  {
+    const int texel_row =
+      texelAt(blit.v + (y - blit.top) * blit.dv, texture_height);
+    blendSpan(target +
+                static_cast<std::size_t>(y) *
+                  static_cast<std::size_t>(render_width) +
+                static_cast<std::size_t>(left),
+              texture.getPixels() + static_cast<std::size_t>(texel_row) *
+                                      static_cast<std::size_t>(texture_width),
+              columns,
+              contiguous,
+              count,
+              blit.tint);
+  }
+}
+
+/**
+ *   @brief   Stretches the frame drawn at the render scale over the
+ *            framebuffer.
+ *   @details Each pixel takes the nearest drawn pixel, and rows are
+ *            copied a band at a time across the thread pool. Does
+ *            nothing at a render scale of 1.
+ *   @return  void
+ */
+void SoftwareRenderer::upscale()
+{
+  if (target == framebuffer.data())
+  {
+    return;
+  }
+
+  jobs.clear();
+  for (int band = 0; band < height; band += tile_size)
+  {
+    jobs.emplace_back([this, band] {
+      const int end = std::min(band + tile_size, height);
+      for (int y = band; y < end; y++)
+      {
+        const int source_row = ((2 * y + 1) * render_height) / (2 * height);
+        const auto* source = target + static_cast<std::size_t>(source_row) *
+                                        static_cast<std::size_t>(render_width);
+        auto* line = framebuffer.data() + static_cast<std::size_t>(y) *
+                                            static_cast<std::size_t>(width);
+        for (std::size_t x = 0; x < upscale_columns.size(); x++)
+        {
+          line[x] = source[upscale_columns[x]];
+        }
+      }
+    });
+  }
+  pool.run(jobs);
+}
@@ -0,0 +1,205 @@
+#pragma once
+#include <Engine/Font.h>
+#include <Engine/Renderer.h>
+#include <Engine/Sprite.h>
+#include <Engine/Texture.h>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "ThreadPool.h"
+
+/** Pixels held in memory as premultiplied RGBA, one word per pixel. */
+class SoftwareTexture : public ASGE::Texture2D
+{
+ public:
+  SoftwareTexture(int width, int height);
+
+  void setData(void* data) override;
+  void* getData() override;
+
+  const std::uint32_t* getPixels() const;
+
+ private:
+  std::vector<std::uint32_t> pixels;
+};
+
+class SoftwareRenderer;
+
+/** A sprite whose texture is held by a SoftwareRenderer. */
+class SoftwareSprite : public ASGE::Sprite
+{
+ public:
+  explicit SoftwareSprite(SoftwareRenderer& owner);
+
+  bool loadTexture(const std::string& file) override;
+  const ASGE::Texture2D* getTexture() const override;
+
+ private:
+  SoftwareRenderer& renderer;
+  std::shared_ptr<SoftwareTexture> texture;
+};
+
+/**
+ *  An ASGE renderer that draws into an RGBA framebuffer in memory, for
+ *  hosts without a GPU.
+ *  Sprites and text are queued as they are rendered, then drawn when
+ *  the frame ends. The framebuffer is split into tiles, each queued
+ *  draw is binned into the tiles it covers, and rows of tiles are drawn
+ *  across a thread pool. Every tile draws its own list in order, so the
+ *  frame is the same for any number of threads. Pixels are blended four
+ *  at a time with SSE2 where it is available.
+ *  Below a render scale of 1, the tiles are drawn into a smaller buffer
+ *  and the frame is upscaled into the framebuffer when it ends, so
+ *  blending costs fall with the square of the scale.
+ *  Text uses a built in 5x7 pixel font. Each glyph is rasterised once
+ *  per size and cached, so drawing text never scales a texture.
+ *  Textures are read from uncompressed TGA files, as stored in the
+ *  asset bundle. Sprites are drawn axis aligned; rotation and shaders
+ *  are not supported.
+ */
+class SoftwareRenderer : public ASGE::Renderer
+{
+ public:
+  struct Stats
+  {
+    std::size_t draws = 0;     /**< Sprites and glyphs in the last frame. */
+    std::size_t binned = 0;    /**< Draws times the tiles they touched. */
+    double raster_ms = 0;      /**< Smoothed time to draw a frame. */
+    double last_raster_ms = 0; /**< Time to draw the last frame. */
+    std::size_t cached_glyphs = 0;
+  };
+
+  enum
+  {
+    tile_size = 64,
+    glyph_columns = 5,
+    glyph_rows = 7,
+    glyph_advance = 6,
+    glyph_line = 9,
+    text_pixel_scale = 2 /**< Screen pixels per font pixel at scale 1. */
+  };
+
+  explicit SoftwareRenderer(
+    unsigned int threads = std::thread::hardware_concurrency());
+  ~SoftwareRenderer() override;
+
+  using ASGE::Renderer::renderSprite;
+  using ASGE::Renderer::renderText;
+
+  bool init(int w, int h, ASGE::Renderer::WindowMode mode) override;
+  bool exit() override;
+  void preRender() override;
+  void postRender() override;
+  void swapBuffers() override;
+
+  void setClearColour(ASGE::Colour rgb) override;
+  void setDefaultTextColour(const ASGE::Colour& colour) override;
+  void setSpriteMode(ASGE::SpriteSortMode mode) override;
+  void setWindowedMode(ASGE::Renderer::WindowMode mode) override;
+  void setWindowTitle(const char* str) override;
+
+  int loadFont(const char* font, int pt) override;
+  int loadFontFromMem(const char* name,
+                      const unsigned char* data,
+                      unsigned int size,
+                      int pt) override;
+  const ASGE::Font& getActiveFont() const override;
+  void setFont(int id) override;
+
+  void renderText(std::string str,
+                  int x,
+                  int y,
+                  float scale,
+                  const ASGE::Colour& colour,
+                  float z_order) override;
+  void renderSprite(const ASGE::Sprite& sprite, float z_order) override;
+
+  std::unique_ptr<ASGE::Input> inputPtr() override;
+  std::unique_ptr<ASGE::Sprite> createUniqueSprite() override;
+  ASGE::Sprite* createRawSprite() override;
+
+  int initPixelShader(std::string shader) override;
+  ASGE::SHADER_LIB::Shader* findShader(int shader_handle) override;
+  void setActiveShader(ASGE::SHADER_LIB::Shader* shader) override;
+
+  std::shared_ptr<SoftwareTexture> loadTexture(const std::string& file);
+  void releaseTexture(const std::string& file);
+  void addTexture(const std::string& file,
+                  int texture_width,
+                  int texture_height,
+                  const std::uint8_t* rgba);
+
+  void setRenderScale(float scale);
+  float getRenderScale() const;
+  int getWidth() const;
+  int getHeight() const;
+  int getRenderWidth() const;
+  int getRenderHeight() const;
+  const std::vector<std::uint32_t>& getPixels() const;
+  bool writePng(const std::string& path) const;
+  std::uint64_t hash() const;
+  Stats getStats() const;
+
+ private:
+  /** A texture drawn to a rectangle of the framebuffer. */
+  struct Blit
+  {
+    const SoftwareTexture* texture = nullptr;
+    int left = 0; /**< The pixels covered, clipped to the framebuffer. */
+    int top = 0;
+    int right = 0;
+    int bottom = 0;
+    std::int64_t u = 0; /**< Texel at the left pixel's centre, 16.16. */
+    std::int64_t v = 0;
+    std::int64_t du = 0; /**< Texels per pixel, 16.16. */
+    std::int64_t dv = 0;
+    std::uint16_t tint[4] = { 256, 256, 256, 256 }; /**< RGBA, 8.8. */
+  };
+
+  void queueBlit(const SoftwareTexture& texture,
+                 const float source[4],
+                 float x,
+                 float y,
+                 float w,
+                 float h,
+                 bool flip_x,
+                 bool flip_y,
+                 const ASGE::Colour& colour,
+                 float opacity);
+  const SoftwareTexture& glyph(char character, int pixel_scale);
+  void resizeTarget();
+  void rasterise();
+  void drawTile(int column, int row);
+  void drawBlit(const Blit& blit, int left, int top, int right, int bottom);
+  void upscale();
+
+  ThreadPool pool;
+  int width = 0;
+  int height = 0;
+  std::vector<std::uint32_t> framebuffer;
+
+  float render_scale = 1.0F;
+  int render_width = 0; /**< The size the tiles are drawn at. */
+  int render_height = 0;
+  std::uint32_t* target = nullptr; /**< The framebuffer, or scaled. */
+  std::vector<std::uint32_t> scaled;
+  std::vector<int> upscale_columns; /**< Source column of each pixel. */
+
+  std::vector<Blit> blits;
+  int tile_columns = 0;
+  int tile_rows = 0;
+  std::vector<std::vector<std::uint32_t>> tile_blits; /**< Draw order. */
+  std::vector<ThreadPool::Job> jobs;
+
+  std::map<std::string, std::shared_ptr<SoftwareTexture>> textures;
+  std::unordered_map<std::uint32_t, std::unique_ptr<SoftwareTexture>>
+    glyphs; /**< By character and pixel scale. */
+  ASGE::Font font;
+
+  Stats stats;
+};
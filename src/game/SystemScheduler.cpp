@@ -0,0 +1,153 @@
+#include "SystemScheduler.h"
+
+#include <algorithm>
+#include <chrono>
+
+/**
+ *   @brief   Constructor.
+ *   @param   thread_pool The pool used to run systems in parallel.
+ */
+SystemScheduler::SystemScheduler(ThreadPool& thread_pool) : pool(thread_pool)
+{
+}
+
+/**
+ *   @brief   Registers a system.
+ *   @details Systems that conflict always run in registration order.
+ *   @param   name Used when reporting timings.
+ *   @param   reads Components the system only reads.
+ *   @param   writes Components the system modifies.
+ *   @param   fn The system body, given the world and the frame delta.
+ *   @return  void
+ */
+void SystemScheduler::add(const std::string& name,
+                          ComponentMask reads,
+                          ComponentMask writes,
+                          SystemFn fn)
+{
+  System system;
+  system.name = name;
+  system.reads = reads;
+  system.writes = writes;
+  system.fn = std::move(fn);
+  systems.push_back(std::move(system));
+  stages_dirty = true;
+}
+
+/**
+ *   @brief   Removes every registered system.
+ *   @return  void
+ */
+void SystemScheduler::clear()
+{
+  systems.clear();
+  stages.clear();
+  stages_dirty = true;
+}
+
+/**
+ *   @brief   Runs every system once.
+ *   @details Systems sharing a stage are dispatched to the thread pool
+ *            and the stage completes before the next one starts.
+ *   @param   world The world the systems operate on.
+ *   @param   dt The frame delta in seconds.
+ *   @return  void
+ */
+void SystemScheduler::run(World& world, float dt)
+{
+  if (stages_dirty)
+  {
+    buildStages();
+  }
+
+  std::vector<ThreadPool::Job> jobs;
+  for (const auto& stage : stages)
+  {
+    jobs.clear();
+    for (auto index : stage)
+    {
+      System* system = &systems[index];
+      jobs.emplace_back(
+        [this, system, &world, dt] { runSystem(*system, world, dt); });
+    }
+    pool.run(jobs);
+    world.flush();
+  }
+}
+
+/**
+ *   @brief   Number of stages the systems were grouped into.
+ *   @return  The stage count.
+ */
+std::size_t SystemScheduler::stageCount()
+{
+  if (stages_dirty)
+  {
+    buildStages();
+  }
+  return stages.size();
+}
+
+/**
+ *   @brief   Per system timings.
+ *   @details The average is an exponential moving average.
+ *   @return  One entry per system, in registration order.
+ */
+std::vector<SystemScheduler::Timing> SystemScheduler::getTimings() const
+{
+  std::vector<Timing> timings;
+  timings.reserve(systems.size());
+  for (const auto& system : systems)
+  {
+    timings.push_back(Timing{
+      system.name, system.stage, system.last_ms, system.average_ms });
+  }
+  return timings;
+}
+
+bool SystemScheduler::conflicts(const System& lhs, const System& rhs)
+{
+  return (lhs.writes & (rhs.reads | rhs.writes)) != 0 ||
+         (rhs.writes & lhs.reads) != 0;
+}
+
+/**
+ *   @brief   Groups the systems into stages.
+ *   @details Each system is placed in the first stage after the last
+ *            stage holding a system it conflicts with.
+ *   @return  void
+ */
+void SystemScheduler::buildStages()
+{
+  stages.clear();
+  for (std::size_t i = 0; i < systems.size(); i++)
+  {
+    std::size_t stage = 0;
+    for (std::size_t j = 0; j < i; j++)
+    {
+      if (conflicts(systems[i], systems[j]))
+      {
+        stage = std::max(stage, systems[j].stage + 1);
+      }
+    }
+
+    systems[i].stage = stage;
+    if (stage == stages.size())
+    {
+      stages.emplace_back();
+    }
+    stages[stage].push_back(i);
+  }
+  stages_dirty = false;
+}
+
+void SystemScheduler::runSystem(System& system, World& world, float dt)
+{
+  const auto start = std::chrono::steady_clock::now();
+  system.fn(world, dt);
+  const std::chrono::duration<double, std::milli> elapsed =
+    std::chrono::steady_clock::now() - start;
+
+  system.last_ms = elapsed.count();
+  system.average_ms += (system.last_ms - system.average_ms) * 0.05;
+}
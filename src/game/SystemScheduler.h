@@ -0,0 +1,63 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "ECS.h"
+#include "ThreadPool.h"
+
+/**
+ *  Runs systems over a World, in parallel where it is safe to do so.
+ *  Every system declares the components it reads and writes. Systems
+ *  are grouped into stages, in registration order, so that no two
+ *  systems in a stage write a component the other touches. The stages
+ *  run one after another and deferred destructions are flushed between
+ *  them.
+ */
+class SystemScheduler
+{
+ public:
+  using SystemFn = std::function<void(World&, float)>;
+
+  struct Timing
+  {
+    std::string name;
+    std::size_t stage = 0;
+    double last_ms = 0;
+    double average_ms = 0;
+  };
+
+  explicit SystemScheduler(ThreadPool& thread_pool);
+
+  void add(const std::string& name,
+           ComponentMask reads,
+           ComponentMask writes,
+           SystemFn fn);
+  void clear();
+  void run(World& world, float dt);
+
+  std::size_t stageCount();
+  std::vector<Timing> getTimings() const;
+
+ private:
+  struct System
+  {
+    std::string name;
+    ComponentMask reads = 0;
+    ComponentMask writes = 0;
+    SystemFn fn;
+    std::size_t stage = 0;
+    double last_ms = 0;
+    double average_ms = 0;
+  };
+
+  static bool conflicts(const System& lhs, const System& rhs);
+  void buildStages();
+  void runSystem(System& system, World& world, float dt);
+
+  ThreadPool& pool;
+  std::vector<System> systems;
+  std::vector<std::vector<std::size_t>> stages;
+  bool stages_dirty = true;
+};
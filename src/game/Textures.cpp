@@ -0,0 +1,30 @@
+#include "Textures.h"
+
+namespace
+{
+  const TextureInfo texture_infos[] = {
+    { "paddleRed", 104, 24 },
+    { "ballBlue", 22, 22 },
+    { "element_green_rectangle", 64, 32 },
+    { "element_purple_rectangle", 64, 32 },
+    { "element_yellow_rectangle", 64, 32 },
+    { "element_grey_rectangle", 64, 32 },
+    { "element_red_rectangle", 64, 32 },
+    { "element_blue_polygon", 48, 46 },
+  };
+
+  static_assert(sizeof(texture_infos) / sizeof(texture_infos[0]) ==
+                  static_cast<std::size_t>(TextureId::COUNT),
+                "a texture is missing its info");
+}
+
+/**
+ *   @brief   Looks up a texture's file name and dimensions.
+ *   @param   id The texture.
+ *   @return  The file name, relative to data/images without the
+ *            extension, and its size in pixels.
+ */
+const TextureInfo& textureInfo(TextureId id)
+{
+  return texture_infos[textureIndex(id)];
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+/** Every texture the game draws with. */
+enum class TextureId : std::uint16_t
+{
+  PADDLE,
+  BALL,
+  BRICK_GREEN,
+  BRICK_PURPLE,
+  BRICK_YELLOW,
+  BRICK_GREY,
+  BRICK_RED,
+  GEM,
+  COUNT
+};
+
+/**
+ *  Where a texture is loaded from and its size in pixels. The sizes
+ *  let the simulation lay out a level without loading any images.
+ */
+struct TextureInfo
+{
+  const char* name;
+  float width;
+  float height;
+};
+
+const TextureInfo& textureInfo(TextureId id);
+
+inline std::size_t textureIndex(TextureId id)
+{
+  return static_cast<std::size_t>(id);
+}
@@ -0,0 +1,124 @@
+#include "ThreadPool.h"
+
+/**
+ *   @brief   Constructor.
+ *   @details Spawns one fewer worker than requested, as the thread
+ *            calling run() also executes jobs.
+ *   @param   threads The total number of threads that may run jobs.
+ */
+ThreadPool::ThreadPool(unsigned int threads)
+{
+  for (unsigned int i = 1; i < threads; i++)
+  {
+    workers.emplace_back(&ThreadPool::workerLoop, this);
+  }
+}
+
+/**
+ *   @brief   Destructor.
+ *   @details Wakes and joins every worker thread.
+ */
+ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  wake.notify_all();
+
+  for (auto& worker : workers)
+  {
+    worker.join();
+  }
+}
+
+/**
+ *   @brief   Number of threads that execute jobs.
+ *   @return  The worker count plus the calling thread.
+ */
+std::size_t ThreadPool::size() const
+{
+  return workers.size() + 1;
+}
+
+/**
+ *   @brief   Runs a batch of jobs to completion.
+ *   @details Queues every job then helps execute queued work until
+ *            the whole batch has finished. Jobs are moved from.
+ *   @param   jobs The jobs to run.
+ *   @return  void
+ */
+void ThreadPool::run(std::vector<Job>& jobs)
+{
+  if (jobs.empty())
+  {
+    return;
+  }
+
+  if (workers.empty() || jobs.size() == 1)
+  {
+    for (auto& job : jobs)
+    {
+      job();
+    }
+    return;
+  }
+
+  Batch batch;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    batch.remaining = jobs.size();
+    for (auto& job : jobs)
+    {
+      queue.push_back(Task{ std::move(job), &batch });
+    }
+  }
+  wake.notify_all();
+
+  std::unique_lock<std::mutex> lock(mutex);
+  while (batch.remaining != 0)
+  {
+    if (!queue.empty())
+    {
+      Task task = std::move(queue.front());
+      queue.pop_front();
+      lock.unlock();
+      execute(task);
+      lock.lock();
+    }
+    else
+    {
+      batch.finished.wait(lock);
+    }
+  }
+}
+
+void ThreadPool::workerLoop()
+{
+  std::unique_lock<std::mutex> lock(mutex);
+  for (;;)
+  {
+    wake.wait(lock, [this] { return stopping || !queue.empty(); });
+    if (stopping && queue.empty())
+    {
+      return;
+    }
+
+    Task task = std::move(queue.front());
+    queue.pop_front();
+    lock.unlock();
+    execute(task);
+    lock.lock();
+  }
+}
+
+void ThreadPool::execute(Task& task)
+{
+  task.job();
+
+  std::lock_guard<std::mutex> lock(mutex);
+  if (--task.batch->remaining == 0)
+  {
+    task.batch->finished.notify_all();
+  }
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ *  A small persistent pool of worker threads.
+ *  Jobs are submitted in batches and the submitting thread helps
+ *  drain the queue until its own batch has completed.
+ */
+class ThreadPool
+{
+ public:
+  using Job = std::function<void()>;
+
+  explicit ThreadPool(
+    unsigned int threads = std::thread::hardware_concurrency());
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  std::size_t size() const;
+  void run(std::vector<Job>& jobs);
+
+ private:
+  struct Batch
+  {
+    std::size_t remaining = 0;
+    std::condition_variable finished;
+  };
+
+  struct Task
+  {
+    Job job;
+    Batch* batch = nullptr;
+  };
+
+  void workerLoop();
+  void execute(Task& task);
+
+  std::vector<std::thread> workers;
+  std::deque<Task> queue;
+  std::mutex mutex;
+  std::condition_variable wake;
+  bool stopping = false;
+};
@@ -0,0 +1,100 @@
+#include "Viewport.h"
+
+#include <algorithm>
+#include <cmath>
+
+/**
+ *   @brief   Constructor.
+ *   @details The window initially matches the virtual resolution.
+ *   @param   virtual_w Width the game is designed for.
+ *   @param   virtual_h Height the game is designed for.
+ */
+Viewport::Viewport(float virtual_w, float virtual_h) :
+  virtual_width(virtual_w),
+  virtual_height(virtual_h),
+  window_width(virtual_w),
+  window_height(virtual_h)
+{
+  update();
+}
+
+void Viewport::setWindowSize(float window_w, float window_h)
+{
+  window_width = window_w;
+  window_height = window_h;
+  update();
+}
+
+void Viewport::setRenderScale(float scale)
+{
+  render_scale = std::max(0.01F, scale);
+}
+
+/**
+ *   @brief   Converts a virtual rectangle to window coordinates.
+ *   @details Edges are snapped to the internal render resolution, so
+ *            both the position and size are rounded.
+ *   @return  The rectangle in window pixels.
+ */
+Viewport::Rect Viewport::toWindow(float x, float y, float w, float h) const
+{
+  const float left = snap(x * output_scale);
+  const float top = snap(y * output_scale);
+
+  Rect rect;
+  rect.x = offset_x + left;
+  rect.y = offset_y + top;
+  rect.w = snap((x + w) * output_scale) - left;
+  rect.h = snap((y + h) * output_scale) - top;
+  return rect;
+}
+
+/**
+ *   @brief   Converts a window position to virtual coordinates.
+ *   @details Used for mouse input.
+ *   @return  void
+ */
+void Viewport::toVirtual(double& x, double& y) const
+{
+  x = (x - offset_x) / output_scale;
+  y = (y - offset_y) / output_scale;
+}
+
+float Viewport::getOutputScale() const
+{
+  return output_scale;
+}
+
+float Viewport::getRenderScale() const
+{
+  return render_scale;
+}
+
+int Viewport::getRenderWidth() const
+{
+  return static_cast<int>(
+    std::lround(virtual_width * output_scale * render_scale));
+}
+
+int Viewport::getRenderHeight() const
+{
+  return static_cast<int>(
+    std::lround(virtual_height * output_scale * render_scale));
+}
+
+void Viewport::update()
+{
+  output_scale =
+    std::min(window_width / virtual_width, window_height / virtual_height);
+  offset_x = std::floor((window_width - virtual_width * output_scale) / 2);
+  offset_y = std::floor((window_height - virtual_height * output_scale) / 2);
+}
+
+/**
+ *   @brief   Rounds an output space value to the internal pixel grid.
+ *   @return  The snapped value, still in output pixels.
+ */
+float Viewport::snap(float value) const
+{
+  return std::round(value * render_scale) / render_scale;
+}
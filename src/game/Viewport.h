@@ -0,0 +1,47 @@
+#pragma once
+
+/**
+ *  Maps the fixed virtual resolution the game is designed for onto the
+ *  window. The virtual area is scaled uniformly and centred, leaving
+ *  black bars on the longer axis. Positions are snapped to the pixel
+ *  grid of the internal render resolution, which is the output size
+ *  multiplied by the render scale.
+ */
+class Viewport
+{
+ public:
+  struct Rect
+  {
+    float x = 0;
+    float y = 0;
+    float w = 0;
+    float h = 0;
+  };
+
+  Viewport(float virtual_w, float virtual_h);
+
+  void setWindowSize(float window_w, float window_h);
+  void setRenderScale(float scale);
+
+  Rect toWindow(float x, float y, float w, float h) const;
+  void toVirtual(double& x, double& y) const;
+
+  float getOutputScale() const;
+  float getRenderScale() const;
+  int getRenderWidth() const;
+  int getRenderHeight() const;
+
+ private:
+  void update();
+  float snap(float value) const;
+
+  float virtual_width = 0;
+  float virtual_height = 0;
+  float window_width = 0;
+  float window_height = 0;
+
+  float render_scale = 1.0F;
+  float output_scale = 1.0F;
+  float offset_x = 0;
+  float offset_y = 0;
+};
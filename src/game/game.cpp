@@ -1,21 +1,38 @@
+#include <chrono>
+#include <cstdio>
 #include <string>
 
 #include <Engine/DebugPrinter.h>
+#include <Engine/FileIO.h>
 #include <Engine/Input.h>
 #include <Engine/InputEvents.h>
 #include <Engine/Keys.h>
 #include <Engine/Sprite.h>
 
+#include "SoftwareRenderer.h"
 #include "game.h"
 
+// PhysFS is linked through ASGE, which does not ship its header
+extern "C"
+{
+  int PHYSFS_unmount(const char* old_dir);
+}
+
 /**
  *   @brief   Default Constructor.
  *   @details Consider setting the game's width and height
  *            and even seeding the random number generator.
  */
-Breakout::Breakout()
+Breakout::Breakout() : viewport(virtual_width, virtual_height)
 {
   game_name = "BREAKOUT";
+
+  render_scale.setLogger([](const RenderScaleController::Decision& decision) {
+    ASGE::DebugPrinter{} << "render scale " << decision.previous_scale
+                         << " -> " << decision.scale << " (average "
+                         << decision.average_ms << "ms at frame "
+                         << decision.frame << ")" << std::endl;
+  });
 }
 
 /**
@@ -24,6 +41,11 @@ Breakout::Breakout()
  */
 Breakout::~Breakout()
 {
+  if (!this->inputs)
+  {
+    return;
+  }
+
   this->inputs->unregisterCallback(static_cast<unsigned int>(key_callback_id));
 
   this->inputs->unregisterCallback(
@@ -45,9 +67,26 @@ bool Breakout::init()
     return false;
   }
 
-  win = false;
+  if (!initGameObjects())
+  {
+    return false;
+  }
+  scripts.spawn(flow());
 
-  initGameObjects();
+  if (!metrics_file.empty() || metrics_port > 0)
+  {
+    metrics_exporter.reset(new MetricsExporter(metrics.getRegistry()));
+    if (!metrics_exporter->start(metrics_file, metrics_port))
+    {
+      ASGE::DebugPrinter{} << "metrics: unable to export to "
+                           << (metrics_file.empty() ? "" : metrics_file + " ")
+                           << (metrics_port > 0
+                                 ? "port " + std::to_string(metrics_port)
+                                 : "")
+                           << std::endl;
+      metrics_exporter.reset();
+    }
+  }
 
   toggleFPS();
 
@@ -65,111 +104,618 @@ bool Breakout::init()
   return true;
 }
 
+/**
+ *   @brief   Loads the sprites and spawns the level.
+ *   @details One sprite is loaded per texture and shared by every
+ *            entity drawn with it.
+ *   @return  True if every sprite loaded.
+ */
 bool Breakout::initGameObjects()
 {
-  if (!paddle.initialiseSprite(renderer.get(), "paddleRed"))
+  const auto start = std::chrono::steady_clock::now();
+  if (use_bundle && !mountBundle())
   {
-    return false;
+    ASGE::DebugPrinter{} << "init::No asset bundle, using loose files"
+                         << std::endl;
   }
 
-  if (!ball.initialiseSprite(renderer.get(), "ballBlue"))
+  sprites.clear();
+  texture_paths.clear();
+  for (std::size_t i = 0; i < textureIndex(TextureId::COUNT); i++)
   {
-    return false;
+    const auto& info = textureInfo(static_cast<TextureId>(i));
+    sprites.emplace_back(renderer->createUniqueSprite());
+    texture_paths.push_back(
+      assetPath("images/" + std::string(info.name) + ".png"));
+    const auto load_start = std::chrono::steady_clock::now();
+    if (!sprites.back()->loadTexture(texture_paths.back()))
+    {
+      ASGE::DebugPrinter{} << "init::Failed to load sprite" << std::endl;
+      return false;
+    }
+    const std::chrono::duration<double, std::milli> load =
+      std::chrono::steady_clock::now() - load_start;
+    metrics.recordAssetLoad(load.count());
   }
 
-  for (int i = 0; i < brick_num; i++)
+  const std::chrono::duration<double, std::milli> elapsed =
+    std::chrono::steady_clock::now() - start;
+  ASGE::DebugPrinter{} << "init::Loaded " << sprites.size() << " textures from "
+                       << (bundle.isMounted() ? "the bundle" : "loose files")
+                       << " in " << elapsed.count() << "ms" << std::endl;
+
+  LevelData level;
+  if (!loadLevel(level))
+  {
+    level = LevelData::defaultLevel();
+  }
+  simulation.reset(virtual_width, virtual_height, level);
+
+  if (!hot_reload_dir.empty())
   {
-    if (!green_bricks[i].initialiseSprite(renderer.get(),
-                                          "element_green_rectangle"))
+    hot_reloader.reset(new HotReloader(hot_reload_dir, "levels/level1.txt"));
+    if (!hot_reloader->start(level))
     {
-      return false;
+      ASGE::DebugPrinter{} << "hot reload: unable to watch " << hot_reload_dir
+                           << std::endl;
+      hot_reloader.reset();
     }
-    if (!purple_bricks[i].initialiseSprite(renderer.get(),
-                                           "element_purple_rectangle"))
+  }
+  return true;
+}
+
+/**
+ *   @brief   Loads the level file.
+ *   @param   level Receives the parsed level.
+ *   @return  False if the file is missing or invalid.
+ */
+bool Breakout::loadLevel(LevelData& level)
+{
+  ASGE::FILEIO::File file;
+  if (!file.open(assetPath("levels/level1.txt")))
+  {
+    ASGE::DebugPrinter{} << "init::Failed to open level" << std::endl;
+    return false;
+  }
+
+  auto buffer = file.read();
+  std::string error;
+  if (!parseLevel(std::string(buffer.as_char(), buffer.length), level, error))
+  {
+    ASGE::DebugPrinter{} << "init::Invalid level, " << error << std::endl;
+    return false;
+  }
+  return true;
+}
+
+/**
+ *   @brief   Swaps in textures and level rows edited on disk.
+ *   @details Called between frames. The watcher thread has already
+ *            read and parsed the files; textures are uploaded here as
+ *            that needs the renderer's thread. Each reload loads from a
+ *            fresh mount point, as textures are cached by path, and the
+ *            mount is removed once the load is done.
+ *   @return  void
+ */
+void Breakout::applyHotReloads()
+{
+  auto pending = hot_reloader->takePending();
+  if (pending.empty())
+  {
+    return;
+  }
+
+  // PhysFS knows a mount by its directory and ignores a second mount of
+  // one, and the data directory is usually mounted already as /data
+  const auto directory = hot_reloader->getDataDirectory() + "/.";
+  for (const auto& reload : pending.textures)
+  {
+    const auto mount_point =
+      "/hot_reload/" + std::to_string(++hot_reload_generation);
+    const auto path = "/data" + mount_point + "/" + reload.file;
+    std::unique_ptr<ASGE::Sprite> sprite(renderer->createUniqueSprite());
+
+    const auto load_start = std::chrono::steady_clock::now();
+    const bool mounted = ASGE::FILEIO::mount(directory, mount_point);
+    const bool loaded = mounted && sprite->loadTexture(path);
+    if (mounted)
     {
-      return false;
+      PHYSFS_unmount(directory.c_str());
     }
-    if (!yellow_bricks[i].initialiseSprite(renderer.get(),
-                                           "element_yellow_rectangle"))
+    if (!loaded)
     {
-      return false;
+      ASGE::DebugPrinter{} << "hot reload: failed " << reload.file
+                           << std::endl;
+      hot_reloader->reportFailed();
+      continue;
     }
-    if (!grey_bricks[i].initialiseSprite(renderer.get(),
-                                         "element_grey_rectangle"))
+
+    const std::chrono::duration<double, std::milli> load =
+      std::chrono::steady_clock::now() - load_start;
+    metrics.recordAssetLoad(load.count());
+
+    const auto index = textureIndex(reload.texture);
+    sprites[index] = std::move(sprite);
+    releaseTexture(texture_paths[index]);
+    texture_paths[index] = path;
+    hot_reloader->reportApplied(reload.detected, 0);
+    ASGE::DebugPrinter{} << "hot reload: " << reload.file << " in "
+                         << hot_reloader->getStats().last_latency_ms << "ms"
+                         << std::endl;
+  }
+
+  for (const auto& reload : pending.levels)
+  {
+    simulation.applyLevel(reload.level, reload.diff);
+    hot_reloader->reportApplied(reload.detected, reload.diff.rows.size());
+    ASGE::DebugPrinter{} << "hot reload: " << reload.diff.rows.size()
+                         << " level rows"
+                         << (reload.diff.gems ? " and gems" : "") << " in "
+                         << hot_reloader->getStats().last_latency_ms << "ms"
+                         << std::endl;
+  }
+}
+
+/**
+ *   @brief   Drops a texture no sprite uses any more from the cache.
+ *   @details Only the software renderer can release a single texture.
+ *            ASGE's GL texture cache can only be emptied as a whole,
+ *            which would free the textures still in use, so under it
+ *            a replaced texture stays cached until exit.
+ *   @param   path The path the texture was loaded from.
+ *   @return  void
+ */
+void Breakout::releaseTexture(const std::string& path)
+{
+  if (software)
+  {
+    software->releaseTexture(path);
+  }
+}
+
+/**
+ *   @brief   Sets the game window resolution
+ *   @details This function is designed to create the window size, any
+ *            aspect ratio scaling factors and safe zones to ensure the
+ *            game frames when resolutions are changed in size.
+ *   @return  void
+ */
+void Breakout::setupResolution()
+{
+  // how will you calculate the game's resolution?
+  // will it scale correctly in full screen? what AR will you use?
+  // how will the game be framed in native 16:9 resolutions?
+  // here are some arbitrary values for you to adjust as you see fit
+  // https://www.gamasutra.com/blogs/KenanBolukbasi/20171002/306822/
+  // Scaling_and_MultiResolution_in_2D_Games.php
+
+  // the game is designed for 720p and the viewport scales it to fit
+  // whatever window size was requested
+  game_width = window_width;
+  game_height = window_height;
+  viewport.setWindowSize(static_cast<float>(game_width),
+                         static_cast<float>(game_height));
+}
+
+/**
+ *   @brief   Requests a window size.
+ *   @details Must be called before init(). The game keeps its virtual
+ *            resolution and is letterboxed to fit.
+ *   @return  void
+ */
+void Breakout::setWindowSize(int width, int height)
+{
+  window_width = width;
+  window_height = height;
+}
+
+/**
+ *   @brief   Watches a data directory for edited assets.
+ *   @details Must be called before init(). Edited textures and level
+ *            rows are swapped in while the game runs.
+ *   @param   data_directory The real path of the data folder to watch.
+ *   @return  void
+ */
+void Breakout::enableHotReload(const std::string& data_directory)
+{
+  hot_reload_dir = data_directory;
+}
+
+/**
+ *   @brief   Plays a large arena of multi-hit bricks instead of the level.
+ *   @details Must be called before init().
+ *   @param   columns The width of the arena in bricks.
+ *   @param   rows The height of the arena in bricks.
+ *   @return  void
+ */
+void Breakout::enableArena(int columns, int rows)
+{
+  simulation.setArena(columns, rows);
+}
+
+/**
+ *   @brief   Simulates the next frame on a worker while this one draws.
+ *   @details Can also be toggled in game with the M key.
+ *   @return  void
+ */
+void Breakout::enablePipeline()
+{
+  pipeline.setPipelined(true);
+}
+
+/**
+ *   @brief   Exports runtime metrics in the Prometheus text format.
+ *   @details Must be called before init(). The metrics are published
+ *            from a background thread, so exporting never blocks a
+ *            frame.
+ *   @param   file_path A file to rewrite every few seconds, or empty.
+ *   @param   port A local port to serve the metrics over HTTP, or zero.
+ *   @return  void
+ */
+void Breakout::enableMetrics(const std::string& file_path, int port)
+{
+  metrics_file = file_path;
+  metrics_port = port;
+}
+
+/**
+ *   @brief   Draws the paddle from the newest input.
+ *   @details Input is polled again just before the draw list is built,
+ *            and the paddle is drawn where its current velocity takes it
+ *            by the time the frame is shown, rather than where the last
+ *            fixed step left it.
+ *   @return  void
+ */
+void Breakout::enableLateLatch()
+{
+  late_latch = true;
+}
+
+/**
+ *   @brief   Loads assets from the loose files instead of the bundle.
+ *   @details Must be called before init().
+ *   @return  void
+ */
+void Breakout::useLooseAssets()
+{
+  use_bundle = false;
+}
+
+/**
+ *   @brief   Maps the asset bundle and mounts it at /bundle.
+ *   @details The bundle is built next to the data folder by the
+ *            AssetPacker build step.
+ *   @return  False if there is no valid bundle.
+ */
+bool Breakout::mountBundle()
+{
+  const auto path = HotReloader::defaultDataDirectory() + "/assets.pak";
+  return bundle.open(path) && bundle.mount("/bundle");
+}
+
+/**
+ *   @brief   The path to load a data file from.
+ *   @details Images in the bundle are stored as TGA.
+ *   @param   file Path relative to the data folder.
+ *   @return  The path within the bundle if it is mounted, or else
+ *            within the data folder.
+ */
+std::string Breakout::assetPath(const std::string& file) const
+{
+  if (!bundle.isMounted())
+  {
+    return "/data/" + file;
+  }
+
+  auto path = "/bundle/" + file;
+  const std::string png = ".png";
+  if (path.size() > png.size() &&
+      path.compare(path.size() - png.size(), png.size(), png) == 0)
+  {
+    path.replace(path.size() - png.size(), png.size(), ".tga");
+  }
+  return path;
+}
+
+/**
+ *   @brief   Times loading every image from loose files and the bundle.
+ *   @details Call after init(). Each source is loaded cold, after being
+ *            evicted from the page cache, and then warm. Every load
+ *            uses a fresh mount point, as textures are cached by path.
+ *            The game's own bundle is closed meanwhile, as its mapping
+ *            would keep the bundle's pages cached.
+ *   @return  void
+ */
+void Breakout::benchmarkAssets()
+{
+  const auto data_dir = HotReloader::defaultDataDirectory();
+  const auto bundle_path = data_dir + "/assets.pak";
+
+  std::vector<std::string> images;
+  {
+    AssetBundle index;
+    if (!index.open(bundle_path))
     {
-      return false;
+      ASGE::DebugPrinter{} << "assets: no bundle at " << bundle_path
+                           << std::endl;
+      return;
     }
-    if (!red_bricks[i].initialiseSprite(renderer.get(),
-                                        "element_red_rectangle"))
+    for (const auto& entry : index.getEntries())
     {
-      return false;
+      if (entry.name.compare(0, 7, "images/") == 0 &&
+          entry.name.size() > 4)
+      {
+        images.push_back(entry.name.substr(0, entry.name.size() - 4));
+      }
     }
   }
 
-  for (int i = 0; i < 4; i++)
+  // see applyHotReloads() for why the directory is mounted as <dir>/.
+  const auto directory = data_dir + "/.";
+  const bool had_bundle = bundle.isMounted();
+  bundle.close();
+
+  std::vector<std::unique_ptr<ASGE::Sprite>> loaded;
+  const auto loadAll = [&](const std::string& root, const char* extension) {
+    for (const auto& image : images)
+    {
+      loaded.emplace_back(renderer->createUniqueSprite());
+      if (!loaded.back()->loadTexture(root + "/" + image + extension))
+      {
+        return false;
+      }
+    }
+    return true;
+  };
+
+  const auto report = [&](const char* source,
+                          bool cold,
+                          bool loaded_all,
+                          std::chrono::steady_clock::time_point start) {
+    const std::chrono::duration<double, std::milli> elapsed =
+      std::chrono::steady_clock::now() - start;
+    ASGE::DebugPrinter{} << "assets: " << source << (cold ? " cold " : " warm ")
+                         << images.size() << " images in " << elapsed.count()
+                         << "ms" << (loaded_all ? "" : " (FAILED)")
+                         << std::endl;
+  };
+
+  int run = 0;
+  for (const bool cold : { true, false })
   {
-    if (!gems[i].initialiseSprite(renderer.get(), "element_blue_polygon"))
+    if (cold)
     {
-      return false;
+      for (const auto& image : images)
+      {
+        AssetBundle::evictFromCache(data_dir + "/" + image + ".png");
+      }
+    }
+    auto mount_point = "/asset_bench/" + std::to_string(++run);
+    auto start = std::chrono::steady_clock::now();
+    const bool mounted = ASGE::FILEIO::mount(directory, mount_point);
+    report("loose files",
+           cold,
+           mounted && loadAll("/data" + mount_point, ".png"),
+           start);
+    if (mounted)
+    {
+      PHYSFS_unmount(directory.c_str());
     }
 
-    gems[i].getSprite()->width(green_bricks[i].getSprite()->height());
-    gems[i].getSprite()->height(green_bricks[i].getSprite()->height());
+    if (cold)
+    {
+      AssetBundle::evictFromCache(bundle_path);
+    }
+    AssetBundle timed;
+    mount_point = "/asset_bench/" + std::to_string(++run);
+    start = std::chrono::steady_clock::now();
+    report("bundle",
+           cold,
+           timed.open(bundle_path) && timed.mount(mount_point) &&
+             loadAll(mount_point, ".tga"),
+           start);
+  }
+
+  if (had_bundle)
+  {
+    mountBundle();
   }
+}
+
+/**
+ *   @brief   Plays the game without a window and saves frames as PNG.
+ *   @details Called instead of init(). Frames are drawn by the software
+ *            renderer at the window size, with a fixed 60Hz time step,
+ *            so the game plays the same on every run. The game plays
+ *            itself, as in an attract mode, and a frame is saved every
+ *            second as capture_NNNN.png in the working directory. The
+ *            render scale follows the measured raster time, so a machine
+ *            that cannot draw within the frame budget saves lower
+ *            resolution frames. The software renderer reads the asset
+ *            bundle's TGA images, so the bundle must have been built.
+ *   @param   frames The number of frames to play.
+ *   @return  The process exit code.
+ */
+int Breakout::capture(int frames)
+{
+  enum
+  {
+    frames_per_second = 60
+  };
 
-  gems[0].getSprite()->xPos(145);
-  gems[0].getSprite()->yPos(30);
+  setupResolution();
+  auto owned = std::make_unique<SoftwareRenderer>();
+  if (!owned->init(
+        game_width, game_height, ASGE::Renderer::WindowMode::WINDOWED))
+  {
+    return 1;
+  }
+  auto& target = *owned;
+  software = owned.get();
+  renderer = std::move(owned);
+  renderer->setClearColour(ASGE::COLOURS::BLACK);
 
-  gems[1].getSprite()->xPos(465);
-  gems[1].getSprite()->yPos(128);
+  if (!initGameObjects())
+  {
+    return 1;
+  }
+  scripts.spawn(flow());
 
-  gems[2].getSprite()->xPos(720);
-  gems[2].getSprite()->yPos(64);
+  ASGE::GameTime game_time;
+  game_time.delta = std::chrono::duration<double, std::milli>(
+    1000.0 / static_cast<double>(frames_per_second));
 
-  gems[3].getSprite()->xPos(912);
-  gems[3].getSprite()->yPos(0);
+  int saved = 0;
+  for (int frame = 1; frame <= frames; frame++)
+  {
+    attractMode();
+    update(game_time);
+    renderer->preRender();
+    render(game_time);
+    renderer->postRender();
 
-  initPaddle();
-  initBall();
+    if (frame % frames_per_second == 0 || frame == frames)
+    {
+      char name[32];
+      std::snprintf(name, sizeof(name), "capture_%04d.png", frame);
+      if (!target.writePng(name))
+      {
+        std::printf("capture: unable to write %s\n", name);
+        return 1;
+      }
+      saved++;
+    }
+  }
+  pipeline.finish();
+
+  const auto stats = target.getStats();
+  std::printf("capture: %d frames, %d saved, raster %.3f ms/frame at "
+              "scale %.3f, %zu draws, %zu cached glyphs\n",
+              frames,
+              saved,
+              stats.raster_ms,
+              static_cast<double>(render_scale.getScale()),
+              stats.draws,
+              stats.cached_glyphs);
+  return 0;
 }
 
-void Breakout::initPaddle()
+/**
+ *   @brief   Stands in for the player while capturing.
+ *   @details Starts a game from any menu, serves, and moves the paddle
+ *            to where the ball is predicted to land.
+ *   @return  void
+ */
+void Breakout::attractMode()
 {
-  paddle.getSprite()->xPos((game_width / 2.0) -
-                           (paddle.getSprite()->width() / 2.0));
-  paddle.getSprite()->yPos(game_height - 50.0);
+  if (screen == Screen::MENU || screen == Screen::GAME_OVER ||
+      screen == Screen::WON)
+  {
+    menu_option = play_option;
+    signalFlow(FlowSignal::SELECT);
+    return;
+  }
+  if (screen != Screen::GAME)
+  {
+    return;
+  }
+
+  const auto& snapshot = pipeline.front();
+  const float paddle_centre =
+    snapshot.paddle.x + textureInfo(TextureId::PADDLE).width / 2;
+  for (const auto& item : snapshot.items)
+  {
+    if (item.texture != TextureId::BALL)
+    {
+      continue;
+    }
+
+    // wait where the ball will come down, or else under the ball
+    const float target = snapshot.prediction.lands && !item.latched
+                           ? snapshot.prediction.landing_x
+                           : item.x + item.w / 2;
+    const int direction = target < paddle_centre - 8   ? -1
+                          : target > paddle_centre + 8 ? 1
+                                                       : 0;
+    if (direction != paddle_direction)
+    {
+      paddle_direction = direction;
+      paddle_changed = true;
+    }
+    serve_requested = item.latched;
+  }
 }
 
-void Breakout::initBall()
+/**
+ *   @brief   The game's screens, as a single script.
+ *   @details Runs for the lifetime of the game. Each screen suspends
+ *            on the flow event until the player or the simulation
+ *            signals it, so nothing is polled in between.
+ */
+Task Breakout::flow()
 {
-  ball.getSprite()->xPos(paddle.getSprite()->xPos() +
-                         (paddle.getSprite()->width() / 2));
-  ball.getSprite()->yPos(game_height - 70.0);
+  co_await menu(Screen::MENU);
+  while (menu_option == play_option)
+  {
+    paddle_direction = 0;
+    paddle_changed = false;
+    simulation.restart();
+    co_await playGame();
+  }
+  signalExit();
+}
 
-  ball_velocity_x = 300;
-  ball_velocity_y = -300;
-  ball.setVelocity(Vector2{ 0, 0 });
+/**
+ *   @brief   Plays one game.
+ *   @details Shows a short countdown before play and after each pause.
+ *            Finishes on the win or game over menu, or when the player
+ *            exits from the pause menu.
+ */
+Task Breakout::playGame()
+{
+  for (;;)
+  {
+    screen = Screen::READY;
+    co_await scripts.sleep(1.0);
+
+    screen = Screen::GAME;
+    const auto signal =
+      static_cast<FlowSignal>(co_await scripts.waitFor(flow_event));
+    if (signal != FlowSignal::PAUSE)
+    {
+      co_await menu(signal == FlowSignal::WON ? Screen::WON
+                                               : Screen::GAME_OVER);
+      co_return;
+    }
+
+    co_await menu(Screen::PAUSED);
+    if (menu_option == exit_option)
+    {
+      co_return;
+    }
+  }
 }
 
 /**
- *   @brief   Sets the game window resolution
- *   @details This function is designed to create the window size, any
- *            aspect ratio scaling factors and safe zones to ensure the
- *            game frames when resolutions are changed in size.
- *   @return  void
+ *   @brief   Shows a play or exit menu until an option is chosen.
+ *   @param   shown The menu's screen.
  */
-void Breakout::setupResolution()
+Task Breakout::menu(Screen shown)
 {
-  // how will you calculate the game's resolution?
-  // will it scale correctly in full screen? what AR will you use?
-  // how will the game be framed in native 16:9 resolutions?
-  // here are some arbitrary values for you to adjust as you see fit
-  // https://www.gamasutra.com/blogs/KenanBolukbasi/20171002/306822/
-  // Scaling_and_MultiResolution_in_2D_Games.php
+  screen = shown;
+  menu_option = play_option;
+  co_await scripts.waitFor(flow_event);
+}
 
-  // 720p is a pretty modest starting point, consider 1080p
-  game_width = 1280;
-  game_height = 720;
+/**
+ *   @brief   Wakes the flow script.
+ *   @details Every screen waits on the same event; the signal tells it
+ *            what happened.
+ *   @return  void
+ */
+void Breakout::signalFlow(FlowSignal signal)
+{
+  scripts.signal(flow_event, static_cast<int>(signal));
 }
 
 /**
@@ -192,41 +738,30 @@ void Breakout::keyHandler(ASGE::SharedEventData data)
     signalExit();
   }
 
-  if (in_menu)
+  if (key->key == ASGE::KEYS::KEY_TAB &&
+      key->action == ASGE::KEYS::KEY_RELEASED)
   {
-    if (key->key == ASGE::KEYS::KEY_LEFT &&
-        key->action == ASGE::KEYS::KEY_RELEASED)
-    {
-      menu_option = 1 - menu_option;
-      // ASGE::DebugPrinter{} << menu_option << std::endl;
-    }
-    else if (key->key == ASGE::KEYS::KEY_RIGHT &&
-             key->action == ASGE::KEYS::KEY_RELEASED)
-    {
-      menu_option = 1 - menu_option;
-      // ASGE::DebugPrinter{} << menu_option << std::endl;
-    }
+    show_stats = !show_stats;
+  }
 
-    if (key->key == ASGE::KEYS::KEY_ENTER)
-    {
-      if (menu_option == 1)
-      {
-        signalExit();
-      }
-      else
-      {
-        in_menu = false;
-        in_game_screen = true;
-      }
-    }
+  if (key->key == ASGE::KEYS::KEY_M &&
+      key->action == ASGE::KEYS::KEY_RELEASED)
+  {
+    toggle_pipeline = true;
   }
 
-  if (in_game_screen)
+  if (key->key == ASGE::KEYS::KEY_G &&
+      key->action == ASGE::KEYS::KEY_RELEASED)
   {
-    if (key->key == ASGE::KEYS::KEY_P)
+    show_path = !show_path;
+  }
+
+  if (screen == Screen::GAME)
+  {
+    if (key->key == ASGE::KEYS::KEY_P &&
+        key->action == ASGE::KEYS::KEY_PRESSED)
     {
-      in_game_screen = false;
-      in_pause_menu = true;
+      signalFlow(FlowSignal::PAUSE);
     }
 
     else if (key->key == ASGE::KEYS::KEY_A)
@@ -234,11 +769,15 @@ void Breakout::keyHandler(ASGE::SharedEventData data)
       if (key->action == ASGE::KEYS::KEY_PRESSED)
       {
         // ASGE::DebugPrinter{} << "A button pressed" << std::endl;
-        paddle.setVelocity(Vector2{ -450, 0 });
+        latency.onInput();
+        paddle_direction = -1;
+        paddle_changed = true;
       }
       else if (key->action == ASGE::KEYS::KEY_RELEASED)
       {
-        paddle.setVelocity(Vector2{ 0, 0 });
+        latency.onInput();
+        paddle_direction = 0;
+        paddle_changed = true;
       }
     }
 
@@ -247,75 +786,39 @@ void Breakout::keyHandler(ASGE::SharedEventData data)
       if (key->action == ASGE::KEYS::KEY_PRESSED)
       {
         // ASGE::DebugPrinter{} << "D button pressed" << std::endl;
-        paddle.setVelocity(Vector2{ 450, 0 });
+        latency.onInput();
+        paddle_direction = 1;
+        paddle_changed = true;
       }
       else if (key->action == ASGE::KEYS::KEY_RELEASED)
       {
-        paddle.setVelocity(Vector2{ 0, 0 });
+        latency.onInput();
+        paddle_direction = 0;
+        paddle_changed = true;
       }
     }
 
     else if (key->key == ASGE::KEYS::KEY_SPACE &&
              key->action == ASGE::KEYS::KEY_PRESSED)
     {
-      serve = true;
-      // ASGE::DebugPrinter{} << "ball_velocity_y: " << ball_velocity_y <<
-      // std::endl;
-      ball.setVelocity(Vector2{ ball_velocity_x, ball_velocity_y });
+      serve_requested = true;
     }
   }
 
-  if (in_pause_menu)
+  if (screen == Screen::MENU || screen == Screen::PAUSED ||
+      screen == Screen::GAME_OVER || screen == Screen::WON)
   {
-    if (key->key == ASGE::KEYS::KEY_LEFT &&
+    if ((key->key == ASGE::KEYS::KEY_LEFT ||
+         key->key == ASGE::KEYS::KEY_RIGHT) &&
         key->action == ASGE::KEYS::KEY_RELEASED)
     {
       menu_option = 1 - menu_option;
     }
-    else if (key->key == ASGE::KEYS::KEY_RIGHT &&
-             key->action == ASGE::KEYS::KEY_RELEASED)
-    {
-      menu_option = 1 - menu_option;
-    }
-
-    if (key->key == ASGE::KEYS::KEY_ENTER)
-    {
-      if (menu_option == 1)
-      {
-        signalExit();
-      }
-      else
-      {
-        in_pause_menu = false;
-        in_game_screen = true;
-      }
-    }
-  }
-
-  if (game_over)
-  {
-    if (key->key == ASGE::KEYS::KEY_LEFT &&
-        key->action == ASGE::KEYS::KEY_RELEASED)
-    {
-      menu_option = 1 - menu_option;
-    }
-    else if (key->key == ASGE::KEYS::KEY_RIGHT &&
-             key->action == ASGE::KEYS::KEY_RELEASED)
-    {
-      menu_option = 1 - menu_option;
-    }
 
     if (key->key == ASGE::KEYS::KEY_ENTER &&
         key->action == ASGE::KEYS::KEY_PRESSED)
     {
-      if (menu_option == 1)
-      {
-        signalExit();
-      }
-      else
-      {
-        // RESTART GAME NOT WORKING
-      }
+      signalFlow(FlowSignal::SELECT);
     }
   }
 }
@@ -339,6 +842,7 @@ void Breakout::clickHandler(ASGE::SharedEventData data)
 
   double x_pos = click->xpos;
   double y_pos = click->ypos;
+  viewport.toVirtual(x_pos, y_pos);
 
   ASGE::DebugPrinter{} << "x_pos: " << x_pos << std::endl;
   ASGE::DebugPrinter{} << "y_pos: " << y_pos << std::endl;
@@ -346,209 +850,127 @@ void Breakout::clickHandler(ASGE::SharedEventData data)
 
 /**
  *   @brief   Updates the scene
- *   @details Prepares the renderer subsystem before drawing the
- *            current frame. Once the current frame is has finished
- *            the buffers are swapped accordingly and the image shown.
+ *   @details Steps the simulation while a game is in progress and
+ *            signals the flow script once it has been won or lost.
+ *            Then resumes any scripts that are due.
  *   @return  void
  */
-
-void Breakout::collisionDetection()
+void Breakout::update(const ASGE::GameTime& game_time)
 {
-  // BALL AND GAME BOUNDARY COLLISION
-  if (ball.getSprite()->xPos() <= 0 ||
-      (ball.getSprite()->xPos() + ball.getSprite()->width()) >= game_width)
-  {
-    // ASGE::DebugPrinter{} << "BOUNCE X" << std::endl;
-    ball.setVelocity(Vector2{ ball_velocity_x *= -1, ball_velocity_y });
-  }
-
-  if (ball.getSprite()->yPos() <= 0)
+  const auto update_start = std::chrono::steady_clock::now();
+  if (frame_start != std::chrono::steady_clock::time_point{})
   {
-    // ASGE::DebugPrinter{} << "BOUNCE Y" << std::endl;
-    ball.setVelocity(Vector2{ ball_velocity_x, ball_velocity_y *= -1 });
+    const std::chrono::duration<double, std::milli> frame =
+      update_start - frame_start;
+    pipeline.recordFrame(frame.count(), main_ms);
+    metrics.recordFrame(frame.count(), update_ms, render_ms);
   }
+  frame_start = update_start;
 
-  if (ball.getSprite()->yPos() + ball.getSprite()->height() >= game_height)
-  {
-    lives_count -= 1;
-    ASGE::DebugPrinter{} << "lives: " << lives_count << std::endl;
-    serve = false;
-    initBall();
-  }
+  auto dt_sec = game_time.delta.count() / 1000.0;
+  // make sure you use delta time in any movement calculations!
 
-  // PADDLE AND BALL COLLISION
-  if (isOverlapping(paddle.getSprite(), ball.getSprite()))
-  {
-    ball.setVelocity(Vector2{ ball_velocity_x, ball_velocity_y *= -1 });
-  }
+  // the previous frame was swapped between its render and this update
+  latency.markDisplayed();
 
-  // BALL AND BRICKS COLLISION
-  for (int i = 0; i < brick_num; i++)
+  // nothing may touch the simulation until its work has finished
+  pipeline.finish();
+  if (toggle_pipeline)
   {
-    if (isOverlapping(ball.getSprite(), red_bricks[i].getSprite()) &&
-        red_bricks[i].visibility)
-    {
-      ball.setVelocity(Vector2{ ball_velocity_x, ball_velocity_y *= -1 });
-      score++;
-      red_bricks[i].visibility = false;
-    }
-    if (isOverlapping(ball.getSprite(), grey_bricks[i].getSprite()) &&
-        grey_bricks[i].visibility)
-    {
-      ball.setVelocity(Vector2{ ball_velocity_x, ball_velocity_y *= -1 });
-      score++;
-      grey_bricks[i].visibility = false;
-    }
-    if (isOverlapping(ball.getSprite(), yellow_bricks[i].getSprite()) &&
-        yellow_bricks[i].visibility)
-    {
-      ball.setVelocity(Vector2{ ball_velocity_x, ball_velocity_y *= -1 });
-      score++;
-      yellow_bricks[i].visibility = false;
-    }
-    if (isOverlapping(ball.getSprite(), purple_bricks[i].getSprite()) &&
-        purple_bricks[i].visibility)
-    {
-      ball.setVelocity(Vector2{ ball_velocity_x, ball_velocity_y *= -1 });
-      score++;
-      purple_bricks[i].visibility = false;
-    }
-    if (isOverlapping(ball.getSprite(), green_bricks[i].getSprite()) &&
-        green_bricks[i].visibility)
-    {
-      ball.setVelocity(Vector2{ ball_velocity_x, ball_velocity_y *= -1 });
-      score++;
-      green_bricks[i].visibility = false;
-    }
+    toggle_pipeline = false;
+    pipeline.setPipelined(!pipeline.isPipelined());
   }
 
-  // GEMS AND PADDLE COLLISION
-  for (int i = 0; i < 4; i++)
+  if (hot_reloader)
   {
-    if (isOverlapping(gems[i].getSprite(), paddle.getSprite()) &&
-        gems[i].visibility)
-    {
-      ASGE::DebugPrinter{} << "gem collected" << std::endl;
-      score += 10;
-      gems[i].visibility = false;
-    }
+    applyHotReloads();
   }
-}
 
-bool Breakout::isOverlapping(ASGE::Sprite* sprite1, ASGE::Sprite* sprite2)
-{
-  if ((sprite2->xPos() < sprite1->xPos() + sprite1->width()) &&
-      (sprite2->xPos() + sprite2->width() > sprite1->xPos()) &&
-
-      (sprite2->yPos() < sprite1->yPos() + sprite1->height()) &&
-      (sprite2->yPos() + sprite2->height() > sprite1->yPos()))
+  // only a renderer that owns its framebuffer can draw at the scale, so
+  // elsewhere the scale stays at 1 and nothing is snapped
+  if (software)
   {
-    return true;
+    render_scale.onFrame(software->getStats().last_raster_ms);
+    viewport.setRenderScale(render_scale.getScale());
+    software->setRenderScale(render_scale.getScale());
   }
-}
 
-void Breakout::update(const ASGE::GameTime& game_time)
-{
-  auto dt_sec = game_time.delta.count() / 1000.0;
-  // make sure you use delta time in any movement calculations!
-
-  if (in_game_screen)
+  if (screen == Screen::GAME)
   {
-    collisionDetection();
-
-    paddle.getSprite()->xPos(paddle.getSprite()->xPos() +
-                             (paddle.getVelocity().x * dt_sec));
+    applyInput();
+    work_input = latency.getLatestInput();
 
-    if (paddle.getSprite()->xPos() <= 0)
+    if (simulation.isLost())
     {
-      paddle.getSprite()->xPos(0);
+      signalFlow(FlowSignal::LOST);
     }
-    if (paddle.getSprite()->xPos() + paddle.getSprite()->width() >= game_width)
+    else if (simulation.isWon())
     {
-      paddle.getSprite()->xPos(game_width - paddle.getSprite()->width());
-    }
-
-    if (!serve)
-    {
-      ball.getSprite()->xPos(paddle.getSprite()->xPos() +
-                             paddle.getSprite()->width() / 2 -
-                             ball.getSprite()->width() / 2);
-
-      ball.getSprite()->yPos(paddle.getSprite()->yPos() -
-                             (ball.getSprite()->height() + 1));
-    }
-    else
-    {
-      ball.getSprite()->xPos(ball.getSprite()->xPos() +
-                             (ball.getVelocity().x * dt_sec));
-
-      ball.getSprite()->yPos(ball.getSprite()->yPos() +
-                             (ball.getVelocity().y * dt_sec));
-    }
-
-    if (lives_count == 0)
-    {
-      in_game_screen = false;
-      game_over = true;
+      signalFlow(FlowSignal::WON);
     }
   }
 
-  int total_brick_count = brick_num * 5;
+  scripts.update(dt_sec);
 
-  for (int i = 0; i < brick_num; i++)
+  advance_seconds = screen == Screen::GAME ? dt_sec : 0;
+  pipeline.start();
+
+  const auto& snapshot = pipeline.front();
+  if (snapshot.sequence != applied_sequence)
   {
-    if (!red_bricks[i].visibility)
-    {
-      total_brick_count--;
-    }
-    if (!grey_bricks[i].visibility)
-    {
-      total_brick_count--;
-    }
-    if (!yellow_bricks[i].visibility)
-    {
-      total_brick_count--;
-    }
-    if (!purple_bricks[i].visibility)
-    {
-      total_brick_count--;
-    }
-    if (!green_bricks[i].visibility)
+    applied_sequence = snapshot.sequence;
+    metrics.recordSnapshot(snapshot);
+    // pipelined, the front ran before this frame's input was applied
+    if (snapshot.steps > 0 && !late_latch)
     {
-      total_brick_count--;
+      latency.markApplied(snapshot.input);
     }
   }
 
-  if (total_brick_count == 0)
-  {
-    in_game_screen = false;
-    win = true;
-  }
-
-  float gem_y_velocity = 200;
+  const std::chrono::duration<double, std::milli> elapsed =
+    std::chrono::steady_clock::now() - update_start;
+  update_ms = elapsed.count();
+  main_ms = update_ms;
+}
 
-  if (!green_bricks[14].visibility)
-  {
-    gems[3].getSprite()->yPos(gems[3].getSprite()->yPos() +
-                              (gem_y_velocity * dt_sec));
-  }
-  if (!purple_bricks[2].visibility)
-  {
-    gems[0].getSprite()->yPos(gems[0].getSprite()->yPos() +
-                              (gem_y_velocity * dt_sec));
-  }
-  if (!yellow_bricks[11].visibility)
+/**
+ *   @brief   Passes the queued input on to the simulation.
+ *   @details Keys can arrive while the simulation is running on the
+ *            pipeline's worker, so they are only applied here, once it
+ *            has finished.
+ *   @return  void
+ */
+void Breakout::applyInput()
+{
+  if (paddle_changed)
   {
-    gems[2].getSprite()->yPos(gems[2].getSprite()->yPos() +
-                              (gem_y_velocity * dt_sec));
+    paddle_changed = false;
+    simulation.setPaddleDirection(paddle_direction);
   }
-  if (!red_bricks[7].visibility)
+  if (serve_requested)
   {
-    gems[1].getSprite()->yPos(gems[1].getSprite()->yPos() +
-                              (gem_y_velocity * dt_sec));
+    serve_requested = false;
+    simulation.serve();
   }
 }
 
+/**
+ *   @brief   The pipeline's work: advances and captures the simulation.
+ *   @details Runs on the pipeline's worker when pipelined, so it must
+ *            only touch the simulation and the snapshot.
+ *   @param   snapshot Receives the new state.
+ *   @return  void
+ */
+void Breakout::stepSimulation(FrameSnapshot& snapshot)
+{
+  snapshot.steps =
+    advance_seconds > 0 ? simulation.advance(advance_seconds) : 0;
+  simulation.capture(snapshot);
+  snapshot.prediction = predictor.predict(simulation);
+  snapshot.captured_at = InputLatency::steadyClock();
+  snapshot.input = work_input;
+}
+
 /**
  *   @brief   Renders the scene
  *   @details Renders all the game objects to the current frame.
@@ -558,156 +980,285 @@ void Breakout::update(const ASGE::GameTime& game_time)
  */
 void Breakout::renderMenuOptions()
 {
-  renderer->renderText(menu_option == 0 ? ">PLAY" : "PLAY",
-                       (game_width * 0.35),
-                       (game_height * 0.8),
-                       1.0,
-                       ASGE::COLOURS::WHITE);
-
-  renderer->renderText(menu_option == 1 ? ">EXIT" : "EXIT",
-                       (game_width * 0.55),
-                       (game_height * 0.8),
-                       1.0,
-                       ASGE::COLOURS::WHITE);
+  drawText(menu_option == 0 ? ">PLAY" : "PLAY",
+           static_cast<float>(virtual_width) * 0.35F,
+           static_cast<float>(virtual_height) * 0.8F,
+           1.0,
+           ASGE::COLOURS::WHITE);
+
+  drawText(menu_option == 1 ? ">EXIT" : "EXIT",
+           static_cast<float>(virtual_width) * 0.55F,
+           static_cast<float>(virtual_height) * 0.8F,
+           1.0,
+           ASGE::COLOURS::WHITE);
 }
 
-void Breakout::render(const ASGE::GameTime&)
+/**
+ *   @brief   Draws text positioned in virtual coordinates.
+ *   @return  void
+ */
+void Breakout::drawText(const std::string& text,
+                        float x,
+                        float y,
+                        float scale,
+                        const ASGE::Colour& colour)
 {
-  renderer->setFont(0);
+  const auto rect = viewport.toWindow(x, y, 0, 0);
+  renderer->renderText(text,
+                       static_cast<int>(rect.x),
+                       static_cast<int>(rect.y),
+                       scale * viewport.getOutputScale(),
+                       colour);
+}
 
-  if (in_menu)
+/**
+ *   @brief   Samples the newest input before the world is drawn.
+ *   @details Key callbacks run during the poll, so any key pressed since
+ *            update() sets the velocity the paddle is drawn ahead with.
+ *   @return  void
+ */
+void Breakout::latchInput()
+{
+  paddle_offset = 0;
+  if (!late_latch || screen != Screen::GAME || !inputs)
   {
-    game_over = false;
-    in_game_screen = false;
-    win = false;
-    in_pause_menu = false;
+    return;
+  }
 
-    renderer->renderText(
-      "MAIN MENU", game_width / 2, game_height / 2, 1.0, ASGE::COLOURS::WHITE);
+  inputs->update();
+  const auto& snapshot = pipeline.front();
+  auto paddle = snapshot.paddle;
+  paddle.velocity = static_cast<float>(paddle_direction) * paddle.speed;
+  paddle_offset =
+    paddle.offsetAfter(InputLatency::steadyClock() - snapshot.captured_at);
+  latency.markApplied();
+}
 
-    renderMenuOptions();
+/**
+ *   @brief   Draws every renderable entity.
+ *   @details Entities sharing a texture share a sprite, which is moved
+ *            into place before each draw.
+ *   @return  void
+ */
+void Breakout::renderWorld(const FrameSnapshot& snapshot)
+{
+  for (const auto& item : snapshot.items)
+  {
+    const auto rect =
+      viewport.toWindow(item.x + (item.latched ? paddle_offset : 0.0F),
+                        item.y,
+                        item.w,
+                        item.h);
+    ASGE::Sprite& sprite = *sprites[textureIndex(item.texture)];
+    sprite.xPos(rect.x);
+    sprite.yPos(rect.y);
+    sprite.width(rect.w);
+    sprite.height(rect.h);
+    renderer->renderSprite(sprite);
   }
+}
 
-  if (in_game_screen)
+/**
+ *   @brief   Draws the aim assist overlay.
+ *   @details A faint ball marks each predicted bounce and where the
+ *            ball reaches the paddle. Toggled with the G key.
+ *   @return  void
+ */
+void Breakout::renderPath(const FrameSnapshot& snapshot)
+{
+  const auto& info = textureInfo(TextureId::BALL);
+  ASGE::Sprite& sprite = *sprites[textureIndex(TextureId::BALL)];
+
+  const auto drawMarker = [&](float x, float y, float opacity) {
+    const auto rect = viewport.toWindow(x, y, info.width, info.height);
+    sprite.xPos(rect.x);
+    sprite.yPos(rect.y);
+    sprite.width(rect.w);
+    sprite.height(rect.h);
+    sprite.opacity(opacity);
+    renderer->renderSprite(sprite);
+  };
+
+  const auto& prediction = snapshot.prediction;
+  for (const auto& contact : prediction.contacts)
   {
-    game_over = false;
-    in_menu = false;
-    win = false;
-    in_pause_menu = false;
-
-    renderer->renderText("IN GAME, PRESS P TO PAUSE OR Esc TO QUIT",
-                         game_width / 2,
-                         game_height / 2,
-                         1.0,
-                         ASGE::COLOURS::WHITE);
-
-    renderer->renderText("LIVES: " + std::to_string(lives_count),
-                         10,
-                         game_height - 6,
-                         1.0,
-                         ASGE::COLOURS::WHITE);
-
-    renderer->renderText("SCORE: " + std::to_string(score),
-                         game_width - 110,
-                         game_height - 6,
-                         1.0,
-                         ASGE::COLOURS::WHITE);
-
-    renderer->renderSprite(*paddle.getSprite());
-
-    for (int i = 0; i < 4; i++)
-    {
-      if (gems[i].visibility)
-      {
-        renderer->renderSprite(*gems[i].getSprite());
-      }
-    }
-
-    for (int i = 0; i < brick_num; i++)
-    {
-      if (green_bricks[i].visibility)
-      {
-        green_bricks[i].getSprite()->xPos(i *
-                                          green_bricks->getSprite()->width());
-        renderer->renderSprite(*green_bricks[i].getSprite());
-      }
-
-      purple_bricks[i].getSprite()->xPos(i *
-                                         purple_bricks->getSprite()->width());
-      purple_bricks[i].getSprite()->yPos(green_bricks->getSprite()->yPos() +
-                                         green_bricks->getSprite()->height());
-      if (purple_bricks[i].visibility)
-      {
-        renderer->renderSprite(*purple_bricks[i].getSprite());
-      }
-
-      yellow_bricks[i].getSprite()->xPos(i *
-                                         yellow_bricks->getSprite()->width());
-      yellow_bricks[i].getSprite()->yPos(purple_bricks->getSprite()->yPos() +
-                                         purple_bricks->getSprite()->height());
-      if (yellow_bricks[i].visibility)
-      {
-        renderer->renderSprite(*yellow_bricks[i].getSprite());
-      }
-
-      grey_bricks[i].getSprite()->xPos(i * grey_bricks->getSprite()->width());
-      grey_bricks[i].getSprite()->yPos(yellow_bricks->getSprite()->yPos() +
-                                       yellow_bricks->getSprite()->height());
-
-      if (grey_bricks[i].visibility)
-      {
-        renderer->renderSprite(*grey_bricks[i].getSprite());
-      }
-
-      red_bricks[i].getSprite()->xPos(i * red_bricks->getSprite()->width());
-      red_bricks[i].getSprite()->yPos(grey_bricks->getSprite()->yPos() +
-                                      grey_bricks->getSprite()->height());
-
-      if (red_bricks[i].visibility)
-      {
-        renderer->renderSprite(*red_bricks[i].getSprite());
-      }
-    }
-
-    renderer->renderSprite(*ball.getSprite());
+    drawMarker(contact.x, contact.y, 0.3F);
   }
-
-  if (in_pause_menu)
+  if (prediction.lands)
   {
-    game_over = false;
-    in_game_screen = false;
-    win = false;
-    in_menu = false;
-
-    renderer->renderText(
-      "PAUSE MENU", game_width / 2, game_height / 2, 1.0, ASGE::COLOURS::WHITE);
-
-    renderMenuOptions();
+    drawMarker(
+      prediction.landing_x - info.width / 2, prediction.landing_y, 0.6F);
   }
+  sprite.opacity(1.0F);
+}
 
-  if (game_over)
+/**
+ *   @brief   Draws the entity and system statistics.
+ *   @details Toggled with the tab key.
+ *   @return  void
+ */
+void Breakout::renderStats(const FrameSnapshot& snapshot)
+{
+  float y_pos = 200;
+  drawText("ENTITIES: " + std::to_string(snapshot.entities) +
+           "  ARCHETYPES: " + std::to_string(snapshot.archetypes) +
+           "  STAGES: " + std::to_string(snapshot.stages),
+           10,
+           y_pos,
+           0.6F,
+           ASGE::COLOURS::YELLOW);
+
+  const auto drawScripts = [&](const std::string& name,
+                                const ScriptScheduler::Stats& stats) {
+    y_pos += 20;
+    drawText(name + " SCRIPTS: " + std::to_string(stats.tasks) +
+               "  SLEEPING: " + std::to_string(stats.sleeping) +
+               "  WAITING: " + std::to_string(stats.waiting) +
+               "  RESUMES: " + std::to_string(stats.resumes) + "  " +
+               std::to_string(stats.average_resume_us) + "us",
+             10,
+             y_pos,
+             0.6F,
+             ASGE::COLOURS::YELLOW);
+  };
+  drawScripts("FLOW", scripts.getStats());
+  drawScripts("SIM", snapshot.scripts);
+
+  const auto frame = pipeline.getStats();
+  y_pos += 20;
+  drawText(std::string("PIPELINE (M) ") +
+             (pipeline.isPipelined() ? "ON" : "OFF") + "  FPS: " +
+             std::to_string(frame.frame_ms > 0 ? 1000 / frame.frame_ms : 0) +
+             "  MAIN: " +
+             std::to_string(frame.frame_ms > 0
+                              ? 100 * frame.main_ms / frame.frame_ms
+                              : 0) +
+             "%  WAIT: " + std::to_string(frame.wait_ms) +
+             "ms  SIM: " + std::to_string(frame.work_ms) + "ms",
+           10,
+           y_pos,
+           0.6F,
+           ASGE::COLOURS::YELLOW);
+
+  const auto drawLatency = [&](const std::string& name,
+                               InputLatency::Stage stage) {
+    const auto stats = latency.getPercentiles(stage);
+    y_pos += 20;
+    drawText(name + " P50: " + std::to_string(stats.p50_ms) +
+               "  P99: " + std::to_string(stats.p99_ms) +
+               "  MAX: " + std::to_string(stats.max_ms) + "ms",
+             10,
+             y_pos,
+             0.6F,
+             ASGE::COLOURS::YELLOW);
+  };
+  y_pos += 20;
+  drawText(std::string("INPUT LATENCY, LATE LATCH ") +
+             (late_latch ? "ON" : "OFF"),
+           10,
+           y_pos,
+           0.6F,
+           ASGE::COLOURS::YELLOW);
+  drawLatency("APPLIED", InputLatency::Stage::APPLIED);
+  drawLatency("SUBMITTED", InputLatency::Stage::SUBMITTED);
+  drawLatency("DISPLAYED", InputLatency::Stage::DISPLAYED);
+
+  for (const auto& timing : snapshot.timings)
   {
-    in_menu = false;
-    in_game_screen = false;
-    win = false;
-    in_pause_menu = false;
+    y_pos += 20;
+    drawText(timing.name + " [" + std::to_string(timing.stage) +
+             "] " + std::to_string(timing.average_ms) + "ms",
+             10,
+             y_pos,
+             0.6F,
+             ASGE::COLOURS::YELLOW);
+  }
+}
 
-    renderer->renderText(
-      "GAME OVER", game_width / 2, game_height / 2, 1.0, ASGE::COLOURS::WHITE);
+void Breakout::render(const ASGE::GameTime&)
+{
+  const auto render_start = std::chrono::steady_clock::now();
+  const auto& snapshot = pipeline.front();
+  renderer->setFont(0);
+  latchInput();
 
-    renderMenuOptions();
+  switch (screen)
+  {
+    case Screen::MENU:
+      drawText("MAIN MENU",
+               virtual_width / 2,
+               virtual_height / 2,
+               1.0,
+               ASGE::COLOURS::WHITE);
+      renderMenuOptions();
+      break;
+
+    case Screen::READY:
+    case Screen::GAME:
+      drawText(screen == Screen::READY
+                 ? "GET READY"
+                 : "IN GAME, PRESS P TO PAUSE OR Esc TO QUIT",
+               virtual_width / 2,
+               virtual_height / 2,
+               1.0,
+               ASGE::COLOURS::WHITE);
+
+      drawText("LIVES: " + std::to_string(snapshot.lives),
+               10,
+               virtual_height - 6,
+               1.0,
+               ASGE::COLOURS::WHITE);
+
+      drawText("SCORE: " + std::to_string(snapshot.score),
+               virtual_width - 110,
+               virtual_height - 6,
+               1.0,
+               ASGE::COLOURS::WHITE);
+
+      renderWorld(snapshot);
+      if (show_path)
+      {
+        renderPath(snapshot);
+      }
+      break;
+
+    case Screen::PAUSED:
+      drawText("PAUSE MENU",
+               virtual_width / 2,
+               virtual_height / 2,
+               1.0,
+               ASGE::COLOURS::WHITE);
+      renderMenuOptions();
+      break;
+
+    case Screen::GAME_OVER:
+      drawText("GAME OVER",
+               virtual_width / 2,
+               virtual_height / 2,
+               1.0,
+               ASGE::COLOURS::WHITE);
+      renderMenuOptions();
+      break;
+
+    case Screen::WON:
+      drawText("YOU WIN",
+               virtual_width / 2,
+               virtual_height / 2,
+               1.0,
+               ASGE::COLOURS::WHITE);
+      renderMenuOptions();
+      break;
   }
 
-  if (win)
+  if (show_stats)
   {
-    game_over = false;
-    in_game_screen = false;
-    in_menu = false;
-    in_pause_menu = false;
+    renderStats(snapshot);
+  }
 
-    renderer->renderText(
-      "YOU WIN", game_width / 2, game_height / 2, 1.0, ASGE::COLOURS::WHITE);
+  latency.markSubmitted();
 
-    renderMenuOptions();
-  }
+  const std::chrono::duration<double, std::milli> elapsed =
+    std::chrono::steady_clock::now() - render_start;
+  render_ms = elapsed.count();
+  main_ms += render_ms;
 }
@@ -1,9 +1,27 @@
 #pragma once
-#include "Vector2.h"
 #include <Engine/OGLGame.h>
+#include <Engine/Sprite.h>
+#include <chrono>
+#include <cstdint>
+#include <memory>
 #include <string>
-
-#include "GameObject.h"
+#include <vector>
+
+#include "AssetBundle.h"
+#include "BallPredictor.h"
+#include "FramePipeline.h"
+#include "GameMetrics.h"
+#include "HotReloader.h"
+#include "InputLatency.h"
+#include "Level.h"
+#include "MetricsExporter.h"
+#include "RenderScaleController.h"
+#include "ScriptScheduler.h"
+#include "Simulation.h"
+#include "Textures.h"
+#include "Viewport.h"
+
+class SoftwareRenderer;
 
 /**
  *  An OpenGL Game based on ASGE.
@@ -14,24 +32,54 @@ class Breakout : public ASGE::OGLGame
   Breakout();
   ~Breakout() final;
   bool init() override;
+  void setWindowSize(int width, int height);
+  void enableHotReload(const std::string& data_directory);
+  void useLooseAssets();
+  void enableLateLatch();
+  void enableArena(int columns, int rows);
+  void enablePipeline();
+  void enableMetrics(const std::string& file_path, int port);
+  void benchmarkAssets();
+  int capture(int frames);
 
   enum
   {
-    brick_num = 20
+    virtual_width = 1280,
+    virtual_height = 720
   };
 
-  GameObject paddle;
-  GameObject ball;
+ private:
+  enum class Screen
+  {
+    MENU,
+    READY,
+    GAME,
+    PAUSED,
+    GAME_OVER,
+    WON
+  };
 
-  GameObject green_bricks[brick_num];
-  GameObject purple_bricks[brick_num];
-  GameObject yellow_bricks[brick_num];
-  GameObject grey_bricks[brick_num];
-  GameObject red_bricks[brick_num];
+  /** Carried by the flow event to the flow script. */
+  enum class FlowSignal
+  {
+    SELECT,
+    PAUSE,
+    WON,
+    LOST
+  };
 
-  GameObject gems[4];
+  enum
+  {
+    flow_event = 1,
+    play_option = 0,
+    exit_option = 1
+  };
+
+  Task flow();
+  Task playGame();
+  Task menu(Screen shown);
+  void signalFlow(FlowSignal signal);
 
- private:
   void keyHandler(ASGE::SharedEventData data);
 
   void clickHandler(ASGE::SharedEventData data);
@@ -40,35 +88,90 @@ class Breakout : public ASGE::OGLGame
 
   bool initGameObjects();
 
-  void initPaddle();
+  bool mountBundle();
 
-  void initBall();
+  void attractMode();
 
-  void collisionDetection();
+  std::string assetPath(const std::string& file) const;
 
-  bool isOverlapping(ASGE::Sprite*, ASGE::Sprite*);
+  bool loadLevel(LevelData& level);
+
+  void applyHotReloads();
+  void releaseTexture(const std::string& path);
+
+  void applyInput();
+
+  void stepSimulation(FrameSnapshot& snapshot);
 
   void update(const ASGE::GameTime&) override;
 
   void renderMenuOptions();
 
-  void render(const ASGE::GameTime&) override;
+  void drawText(const std::string& text,
+                float x,
+                float y,
+                float scale,
+                const ASGE::Colour& colour);
 
-  int key_callback_id = -1;   /**< Key Input Callback ID. */
-  int mouse_callback_id = -1; /**< Mouse Input Callback ID. */
+  void latchInput();
 
-  int menu_option = 0;
+  void renderWorld(const FrameSnapshot& snapshot);
 
-  bool in_menu = true;
-  bool in_game_screen = false;
-  bool in_pause_menu = false;
-  bool game_over = false;
-  bool win = false;
+  void renderPath(const FrameSnapshot& snapshot);
 
-  float ball_velocity_x = 300;
-  float ball_velocity_y = -300;
+  void renderStats(const FrameSnapshot& snapshot);
+
+  void render(const ASGE::GameTime&) override;
+
+  int key_callback_id = -1;   /**< Key Input Callback ID. */
+  int mouse_callback_id = -1; /**< Mouse Input Callback ID. */
 
-  bool serve = false;
-  int lives_count = 3;
-  int score = 0;
-};
\ No newline at end of file
+  int window_width = virtual_width;
+  int window_height = virtual_height;
+  Viewport viewport;
+  RenderScaleController render_scale;
+  SoftwareRenderer* software = nullptr; /**< Set while capturing. */
+
+  Simulation simulation;
+  BallPredictor predictor; /**< Only used with the simulation. */
+  AssetBundle bundle;
+  bool use_bundle = true;
+  std::vector<std::unique_ptr<ASGE::Sprite>> sprites; /**< By TextureId. */
+  std::vector<std::string> texture_paths; /**< Loaded from, by TextureId. */
+
+  InputLatency latency;
+  bool late_latch = false;
+  float paddle_offset = 0; /**< Late latched paddle movement. */
+
+  /** Input is queued while the simulation may be running. */
+  int paddle_direction = 0;
+  bool paddle_changed = false;
+  bool serve_requested = false;
+  bool toggle_pipeline = false;
+
+  double advance_seconds = 0; /**< How far the next work advances. */
+  std::uint64_t work_input = 0; /**< Newest input the next work applies. */
+  std::uint64_t applied_sequence = 0;
+  std::chrono::steady_clock::time_point frame_start;
+  double update_ms = 0;
+  double render_ms = 0;
+  double main_ms = 0; /**< Update and render time this frame. */
+  FramePipeline pipeline{ [this](FrameSnapshot& snapshot) {
+    stepSimulation(snapshot);
+  } };
+
+  GameMetrics metrics;
+  std::string metrics_file;
+  int metrics_port = 0;
+  std::unique_ptr<MetricsExporter> metrics_exporter;
+
+  std::string hot_reload_dir;
+  std::unique_ptr<HotReloader> hot_reloader;
+  int hot_reload_generation = 0;
+
+  ScriptScheduler scripts;
+  Screen screen = Screen::MENU;
+  int menu_option = play_option;
+  bool show_stats = false;
+  bool show_path = false;
+};
@@ -1,10 +1,151 @@
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "Arena.h"
+#include "ArenaBench.h"
+#include "HotReloader.h"
+#include "LatencyCheck.h"
+#include "PipelineBench.h"
+#include "PhysicsBench.h"
+#include "PredictorCheck.h"
+#include "RasterBench.h"
+#include "RenderScaleCheck.h"
 #include "game.h"
-int main()
+
+int main(int argc, char* argv[])
 {
+  // headless modes, run without opening a window
+  for (int i = 1; i < argc; i++)
+  {
+    const std::string arg = argv[i];
+    const bool has_value = i + 1 < argc && argv[i + 1][0] != '-';
+
+    if (arg == "--determinism")
+    {
+      return runDeterminismCheck(has_value ? std::atoi(argv[i + 1])
+                                           : determinism_default_steps);
+    }
+    if (arg == "--bench-physics")
+    {
+      return runPhysicsBenchmark();
+    }
+    if (arg == "--bench-arena")
+    {
+      return runArenaBenchmark();
+    }
+    if (arg == "--bench-pipeline")
+    {
+      return runPipelineBenchmark();
+    }
+    if (arg == "--check-latency")
+    {
+      return runLatencyCheck();
+    }
+    if (arg == "--bench-raster")
+    {
+      return runRasterBenchmark();
+    }
+    if (arg == "--check-predictor")
+    {
+      return runPredictorCheck();
+    }
+    if (arg == "--check-render-scale")
+    {
+      return runRenderScaleCheck();
+    }
+  }
+
   Breakout asge_game;
+  bool bench_assets = false;
+  int capture_frames = 0;
+  std::string metrics_file;
+  int metrics_port = 0;
+
+  for (int i = 1; i < argc; i++)
+  {
+    const std::string arg = argv[i];
+    const bool has_value = i + 1 < argc && argv[i + 1][0] != '-';
+
+    int width = 0;
+    int height = 0;
+    if (arg == "--window" && has_value &&
+        std::sscanf(argv[i + 1], "%dx%d", &width, &height) == 2)
+    {
+      asge_game.setWindowSize(width, height);
+    }
+    else if (arg == "--watch")
+    {
+      asge_game.enableHotReload(
+        has_value ? argv[i + 1] : HotReloader::defaultDataDirectory());
+    }
+    else if (arg == "--loose-assets")
+    {
+      asge_game.useLooseAssets();
+    }
+    else if (arg == "--arena")
+    {
+      int columns = 500;
+      int rows = 200;
+      if (has_value &&
+          (std::sscanf(argv[i + 1], "%dx%d", &columns, &rows) != 2 ||
+           columns < 1 || columns > Arena::max_side || rows < 1 ||
+           rows > Arena::max_side ||
+           static_cast<long long>(columns) * rows > Arena::max_cells))
+      {
+        std::fprintf(stderr,
+                     "--arena expects COLUMNSxROWS, each 1 to %d and at "
+                     "most %d bricks\n",
+                     static_cast<int>(Arena::max_side),
+                     static_cast<int>(Arena::max_cells));
+        return 1;
+      }
+      asge_game.enableArena(columns, rows);
+    }
+    else if (arg == "--pipeline")
+    {
+      asge_game.enablePipeline();
+    }
+    else if (arg == "--late-latch")
+    {
+      asge_game.enableLateLatch();
+    }
+    else if (arg == "--metrics-file" && has_value)
+    {
+      metrics_file = argv[i + 1];
+    }
+    else if (arg == "--metrics-port" && has_value)
+    {
+      metrics_port = std::atoi(argv[i + 1]);
+    }
+    else if (arg == "--bench-assets")
+    {
+      bench_assets = true;
+    }
+    else if (arg == "--capture")
+    {
+      capture_frames = has_value ? std::atoi(argv[i + 1]) : 600;
+    }
+  }
+
+  if (!metrics_file.empty() || metrics_port > 0)
+  {
+    asge_game.enableMetrics(metrics_file, metrics_port);
+  }
+
+  if (capture_frames > 0)
+  {
+    return asge_game.capture(capture_frames);
+  }
+
   if (asge_game.init())
   {
+    if (bench_assets)
+    {
+      asge_game.benchmarkAssets();
+      return 0;
+    }
     asge_game.run();
   }
   return 0;
-}
\ No newline at end of file
+}
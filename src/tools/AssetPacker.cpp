@@ -0,0 +1,367 @@
+/**
+ *  Packs the game data into a single bundle at build time.
+ *  Usage: AssetPacker <data directory> <bundle>
+ *
+ *  The bundle is a Quake PAK archive, which PhysFS mounts directly: a
+ *  12 byte header, the index of 64 byte entries straight after it, then
+ *  the file data with each entry aligned to 16 bytes. Images are decoded
+ *  here and stored as uncompressed 32 bit TGA with a top left origin, so
+ *  loading one is a copy of its pixels. Other files are stored as is.
+ */
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <zlib.h>
+
+namespace
+{
+  enum
+  {
+    pak_header_size = 12,
+    pak_entry_size = 64,
+    pak_name_size = 56,
+    pak_alignment = 16
+  };
+
+  struct Image
+  {
+    std::uint32_t width = 0;
+    std::uint32_t height = 0;
+    std::vector<std::uint8_t> rgba;
+  };
+
+  struct PackedFile
+  {
+    std::string name;
+    std::vector<std::uint8_t> data;
+  };
+
+  bool readFile(const std::filesystem::path& path,
+                std::vector<std::uint8_t>& contents)
+  {
+    std::ifstream stream(path, std::ios::binary | std::ios::ate);
+    const auto length = stream.tellg();
+    if (!stream || length < 0)
+    {
+      return false;
+    }
+
+    contents.resize(static_cast<std::size_t>(length));
+    stream.seekg(0);
+    return static_cast<bool>(
+      stream.read(reinterpret_cast<char*>(contents.data()),
+                  static_cast<std::streamsize>(length)));
+  }
+
+  std::uint32_t readBigEndian(const std::uint8_t* bytes)
+  {
+    return (static_cast<std::uint32_t>(bytes[0]) << 24) |
+           (static_cast<std::uint32_t>(bytes[1]) << 16) |
+           (static_cast<std::uint32_t>(bytes[2]) << 8) |
+           static_cast<std::uint32_t>(bytes[3]);
+  }
+
+  void writeLittleEndian(std::vector<std::uint8_t>& out,
+                         std::size_t offset,
+                         std::uint32_t value)
+  {
+    for (std::size_t i = 0; i < 4; i++)
+    {
+      out[offset + i] = static_cast<std::uint8_t>(value >> (8 * i));
+    }
+  }
+
+  std::uint8_t paeth(int left, int up, int up_left)
+  {
+    const int estimate = left + up - up_left;
+    const int to_left = std::abs(estimate - left);
+    const int to_up = std::abs(estimate - up);
+    const int to_up_left = std::abs(estimate - up_left);
+    if (to_left <= to_up && to_left <= to_up_left)
+    {
+      return static_cast<std::uint8_t>(left);
+    }
+    return static_cast<std::uint8_t>(to_up <= to_up_left ? up : up_left);
+  }
+
+  /**
+   *   @brief   Decodes a PNG to RGBA.
+   *   @details Supports the 8 bit, non interlaced grey, grey alpha, RGB
+   *            and RGBA images the game ships with.
+   *   @return  False with a reason in error if the image is unsupported.
+   */
+  bool decodePng(const std::vector<std::uint8_t>& png,
+                 Image& image,
+                 std::string& error)
+  {
+    static const std::uint8_t signature[] = { 137, 80, 78, 71,
+                                              13,  10, 26, 10 };
+    if (png.size() < 8 || std::memcmp(png.data(), signature, 8) != 0)
+    {
+      error = "not a PNG";
+      return false;
+    }
+
+    int colour_type = -1;
+    std::vector<std::uint8_t> compressed;
+    std::size_t pos = 8;
+    while (pos + 12 <= png.size())
+    {
+      const std::uint32_t length = readBigEndian(&png[pos]);
+      const std::string type(reinterpret_cast<const char*>(&png[pos + 4]), 4);
+      const std::uint8_t* body = &png[pos + 8];
+      if (pos + 12 + length > png.size())
+      {
+        error = "truncated chunk";
+        return false;
+      }
+
+      if (type == "IHDR")
+      {
+        image.width = readBigEndian(body);
+        image.height = readBigEndian(body + 4);
+        colour_type = body[9];
+        if (body[8] != 8 || body[12] != 0)
+        {
+          error = "only 8 bit non interlaced images are supported";
+          return false;
+        }
+      }
+      else if (type == "IDAT")
+      {
+        compressed.insert(compressed.end(), body, body + length);
+      }
+      else if (type == "IEND")
+      {
+        break;
+      }
+      pos += 12 + length;
+    }
+
+    std::size_t channels = 0;
+    switch (colour_type)
+    {
+      case 0:
+        channels = 1;
+        break;
+      case 2:
+        channels = 3;
+        break;
+      case 4:
+        channels = 2;
+        break;
+      case 6:
+        channels = 4;
+        break;
+      default:
+        error = "unsupported colour type";
+        return false;
+    }
+
+    const std::size_t stride = image.width * channels;
+    std::vector<std::uint8_t> filtered(image.height * (stride + 1));
+    uLongf filtered_size = filtered.size();
+    if (uncompress(filtered.data(),
+                   &filtered_size,
+                   compressed.data(),
+                   compressed.size()) != Z_OK ||
+        filtered_size != filtered.size())
+    {
+      error = "corrupt image data";
+      return false;
+    }
+
+    std::vector<std::uint8_t> pixels(image.height * stride);
+    for (std::size_t y = 0; y < image.height; y++)
+    {
+      const std::uint8_t filter = filtered[y * (stride + 1)];
+      const std::uint8_t* in = &filtered[y * (stride + 1) + 1];
+      std::uint8_t* row = &pixels[y * stride];
+      const std::uint8_t* prior = y > 0 ? row - stride : nullptr;
+
+      for (std::size_t x = 0; x < stride; x++)
+      {
+        const int left = x >= channels ? row[x - channels] : 0;
+        const int up = prior ? prior[x] : 0;
+        const int up_left = prior && x >= channels ? prior[x - channels] : 0;
+
+        int predicted = 0;
+        switch (filter)
+        {
+          case 0:
+            break;
+          case 1:
+            predicted = left;
+            break;
+          case 2:
+            predicted = up;
+            break;
+          case 3:
+            predicted = (left + up) / 2;
+            break;
+          case 4:
+            predicted = paeth(left, up, up_left);
+            break;
+          default:
+            error = "bad filter";
+            return false;
+        }
+        row[x] = static_cast<std::uint8_t>(in[x] + predicted);
+      }
+    }
+
+    image.rgba.resize(image.width * image.height * 4);
+    for (std::size_t i = 0; i < image.width * image.height; i++)
+    {
+      const std::uint8_t* in = &pixels[i * channels];
+      std::uint8_t* out = &image.rgba[i * 4];
+      const bool grey = channels < 3;
+      out[0] = in[0];
+      out[1] = grey ? in[0] : in[1];
+      out[2] = grey ? in[0] : in[2];
+      out[3] = channels == 2 ? in[1] : (channels == 4 ? in[3] : 255);
+    }
+    return true;
+  }
+
+  /**
+   *   @brief   Encodes an uncompressed, top left origin, 32 bit TGA.
+   *   @return  The file's bytes.
+   */
+  std::vector<std::uint8_t> encodeTga(const Image& image)
+  {
+    std::vector<std::uint8_t> tga(18 + image.rgba.size());
+    tga[2] = 2; // uncompressed true colour
+    tga[12] = static_cast<std::uint8_t>(image.width & 0xFF);
+    tga[13] = static_cast<std::uint8_t>(image.width >> 8);
+    tga[14] = static_cast<std::uint8_t>(image.height & 0xFF);
+    tga[15] = static_cast<std::uint8_t>(image.height >> 8);
+    tga[16] = 32;
+    tga[17] = 0x28; // 8 alpha bits, top left origin
+
+    for (std::size_t i = 0; i < image.rgba.size(); i += 4)
+    {
+      tga[18 + i] = image.rgba[i + 2];
+      tga[18 + i + 1] = image.rgba[i + 1];
+      tga[18 + i + 2] = image.rgba[i];
+      tga[18 + i + 3] = image.rgba[i + 3];
+    }
+    return tga;
+  }
+
+  /**
+   *   @brief   Collects the files to pack, decoding every PNG.
+   *   @return  False if a file could not be read or decoded.
+   */
+  bool collect(const std::filesystem::path& root,
+               std::vector<PackedFile>& files)
+  {
+    for (const auto& item :
+         std::filesystem::recursive_directory_iterator(root))
+    {
+      if (!item.is_regular_file())
+      {
+        continue;
+      }
+
+      PackedFile file;
+      file.name = item.path().lexically_relative(root).generic_string();
+      if (!readFile(item.path(), file.data))
+      {
+        std::fprintf(stderr, "AssetPacker: cannot read %s\n",
+                     file.name.c_str());
+        return false;
+      }
+
+      if (item.path().extension() == ".png")
+      {
+        Image image;
+        std::string error;
+        if (!decodePng(file.data, image, error))
+        {
+          std::fprintf(stderr, "AssetPacker: %s: %s\n",
+                       file.name.c_str(), error.c_str());
+          return false;
+        }
+        file.data = encodeTga(image);
+        file.name.replace(file.name.size() - 4, 4, ".tga");
+      }
+
+      if (file.name.size() >= pak_name_size)
+      {
+        std::fprintf(stderr, "AssetPacker: name too long %s\n",
+                     file.name.c_str());
+        return false;
+      }
+      files.push_back(std::move(file));
+    }
+
+    // a stable order keeps the bundle reproducible
+    std::sort(files.begin(),
+              files.end(),
+              [](const PackedFile& lhs, const PackedFile& rhs) {
+                return lhs.name < rhs.name;
+              });
+    return true;
+  }
+
+  std::size_t align(std::size_t offset)
+  {
+    return (offset + pak_alignment - 1) / pak_alignment * pak_alignment;
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc != 3)
+  {
+    std::fprintf(stderr, "usage: AssetPacker <data directory> <bundle>\n");
+    return 1;
+  }
+
+  std::vector<PackedFile> files;
+  if (!collect(argv[1], files))
+  {
+    return 1;
+  }
+
+  const std::size_t index_size = files.size() * pak_entry_size;
+  std::vector<std::uint8_t> bundle(align(pak_header_size + index_size));
+  std::memcpy(bundle.data(), "PACK", 4);
+  writeLittleEndian(bundle, 4, pak_header_size);
+  writeLittleEndian(bundle, 8, static_cast<std::uint32_t>(index_size));
+
+  for (std::size_t i = 0; i < files.size(); i++)
+  {
+    const std::size_t entry = pak_header_size + i * pak_entry_size;
+    const std::size_t offset = bundle.size();
+    std::memcpy(&bundle[entry], files[i].name.c_str(), files[i].name.size());
+    writeLittleEndian(bundle, entry + 56, static_cast<std::uint32_t>(offset));
+    writeLittleEndian(
+      bundle, entry + 60, static_cast<std::uint32_t>(files[i].data.size()));
+
+    bundle.insert(bundle.end(), files[i].data.begin(), files[i].data.end());
+    bundle.resize(align(bundle.size()));
+  }
+
+  std::ofstream out(argv[2], std::ios::binary | std::ios::trunc);
+  out.write(reinterpret_cast<const char*>(bundle.data()),
+            static_cast<std::streamsize>(bundle.size()));
+  if (!out)
+  {
+    std::fprintf(stderr, "AssetPacker: cannot write %s\n", argv[2]);
+    return 1;
+  }
+
+  std::printf("AssetPacker: %zu files, %zu bytes\n",
+              files.size(),
+              bundle.size());
+  return 0;
+}